@@ -0,0 +1,293 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "approximatematcher.h"
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
+namespace
+{
+constexpr int sBlockBits = 64;
+constexpr quint64 sHighBit = quint64(1) << (sBlockBits - 1);
+// cost of edits that are not permitted, large enough to never be within an error bound
+constexpr int sForbidden = std::numeric_limits<int>::max() / 4;
+
+// tokens after which a number is a version, like in "version 2", "GPL 3" or "v 2.1"
+bool isVersionPrefix(QStringView token)
+{
+    for (const char *prefix : {"version", "v", "gpl", "lgpl", "agpl", "fdl", "gfdl"}) {
+        if (token.compare(QLatin1String(prefix), Qt::CaseInsensitive) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// tokens like "v2", "GPLv3" or "LGPL2"
+bool isVersionToken(QStringView token)
+{
+    int digitsStart = 0;
+    while (digitsStart < token.size() && !token.at(digitsStart).isDigit()) {
+        ++digitsStart;
+    }
+    if (digitsStart == 0 || digitsStart == token.size()) {
+        return false;
+    }
+    QStringView prefix = token.left(digitsStart);
+    if (prefix.size() > 1 && prefix.endsWith(QLatin1Char('v'), Qt::CaseInsensitive)) {
+        prefix.chop(1);
+    }
+    return isVersionPrefix(prefix);
+}
+
+bool containsDigit(QStringView token)
+{
+    return std::any_of(token.begin(), token.end(), [](QChar character) {
+        return character.isDigit();
+    });
+}
+
+/**
+ * Advances one block of the bit-parallel edit distance computation by one text token,
+ * following the blocked variant of Myers' algorithm.
+ * @param hin horizontal delta entering the block at its top row
+ * @param lastRowBit bit of the last pattern row within this block
+ * @return horizontal delta leaving the block at its last row
+ */
+inline int advanceBlock(quint64 &pv, quint64 &mv, quint64 eq, int hin, quint64 lastRowBit)
+{
+    const quint64 hinIsNegative = hin < 0 ? 1 : 0;
+    const quint64 xv = eq | mv;
+    eq |= hinIsNegative;
+    const quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+    quint64 ph = mv | ~(xh | pv);
+    quint64 mh = pv & xh;
+
+    int hout = 0;
+    if (ph & lastRowBit) {
+        hout = 1;
+    } else if (mh & lastRowBit) {
+        hout = -1;
+    }
+
+    ph <<= 1;
+    mh <<= 1;
+    mh |= hinIsNegative;
+    ph |= hin > 0 ? 1 : 0;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    return hout;
+}
+}
+
+ApproximateMatcher::ApproximateMatcher(double errorRate, int maxTextTokens)
+    : mErrorRate(errorRate)
+    , mMaxTextTokens(maxTextTokens)
+{
+}
+
+void ApproximateMatcher::setText(const QString &text)
+{
+    mText = text;
+    LicenseTokenizer::tokenize(mText, mTextTokens, mMaxTextTokens);
+    mTextTokenIdsVocabularySize = -1;
+}
+
+void ApproximateMatcher::updateTextTokenIds() const
+{
+    // token ids only change when new pattern tokens were added to the vocabulary
+    if (mTextTokenIdsVocabularySize == mVocabulary.size()) {
+        return;
+    }
+    mTextTokenIds.resize(mTextTokens.size());
+    for (std::size_t i = 0; i < mTextTokens.size(); ++i) {
+        const LicenseTokenizer::Token &token = mTextTokens[i];
+        mTextTokenIds[i] = mVocabulary.value(LicenseTokenizer::tokenHash(QStringView(mText).mid(token.start, token.end - token.start)), -1);
+    }
+    mTextTokenIdsVocabularySize = mVocabulary.size();
+}
+
+const ApproximateMatcher::CompiledPattern &ApproximateMatcher::compiledPattern(const QString &pattern) const
+{
+    auto iter = mPatternCache.constFind(pattern);
+    if (iter != mPatternCache.constEnd()) {
+        return iter.value();
+    }
+
+    std::vector<LicenseTokenizer::Token> tokens;
+    LicenseTokenizer::tokenize(pattern, tokens);
+    CompiledPattern compiled;
+    std::vector<int> &tokenIds = compiled.tokenIds;
+    tokenIds.reserve(tokens.size());
+    compiled.version.reserve(tokens.size());
+    QStringView previousToken;
+    for (const auto &token : tokens) {
+        const QStringView tokenText = QStringView(pattern).mid(token.start, token.end - token.start);
+        const quint64 hash = LicenseTokenizer::tokenHash(tokenText);
+        auto vocabularyIter = mVocabulary.constFind(hash);
+        if (vocabularyIter == mVocabulary.constEnd()) {
+            vocabularyIter = mVocabulary.insert(hash, mVocabulary.size());
+        }
+        tokenIds.push_back(vocabularyIter.value());
+        // numbers that follow a version number, like the minor version in "2.1", are versions as well
+        const bool previousIsVersion = !compiled.version.empty() && compiled.version.back();
+        const bool version = isVersionToken(tokenText)
+            || (containsDigit(tokenText) && (isVersionPrefix(previousToken) || (previousIsVersion && containsDigit(previousToken))));
+        compiled.version.push_back(version);
+        compiled.hasVersion = compiled.hasVersion || version;
+        previousToken = tokenText;
+    }
+
+    compiled.length = static_cast<int>(tokenIds.size());
+    const int blockCount = (compiled.length + sBlockBits - 1) / sBlockBits;
+    auto setBit = [blockCount](Peq &peq, int tokenId, int row) {
+        auto offsetIter = peq.offsets.constFind(tokenId);
+        if (offsetIter == peq.offsets.constEnd()) {
+            offsetIter = peq.offsets.insert(tokenId, static_cast<int>(peq.blocks.size()));
+            peq.blocks.resize(peq.blocks.size() + blockCount, 0);
+        }
+        peq.blocks[offsetIter.value() + row / sBlockBits] |= quint64(1) << (row % sBlockBits);
+    };
+    for (int row = 0; row < compiled.length; ++row) {
+        setBit(compiled.forward, tokenIds[row], row);
+        setBit(compiled.reverse, tokenIds[compiled.length - 1 - row], row);
+    }
+
+    CompiledPattern &cached = mPatternCache[pattern];
+    cached = std::move(compiled);
+    return cached;
+}
+
+std::pair<int, int> ApproximateMatcher::search(const Peq &peq,
+                                               int patternLength,
+                                               int begin,
+                                               int end,
+                                               int step,
+                                               int stopScore,
+                                               bool preferLast,
+                                               int bound,
+                                               std::pair<int, int> *withinBound) const
+{
+    const int blockCount = (patternLength + sBlockBits - 1) / sBlockBits;
+    const quint64 lastBlockRowBit = quint64(1) << ((patternLength - 1) % sBlockBits);
+    mPv.assign(blockCount, ~quint64(0));
+    mMv.assign(blockCount, 0);
+
+    int score = patternLength;
+    int bestScore = patternLength;
+    int firstBestPosition = -1;
+    int lastBestPosition = -1;
+    for (int position = begin; position != end; position += step) {
+        const quint64 *eq = nullptr;
+        auto offsetIter = peq.offsets.constFind(mTextTokenIds[position]);
+        if (offsetIter != peq.offsets.constEnd()) {
+            eq = &peq.blocks[offsetIter.value()];
+        }
+        int hin = 0; // top row of the matrix is zero: a match may start at any text position
+        for (int block = 0; block < blockCount; ++block) {
+            const quint64 lastRowBit = block == blockCount - 1 ? lastBlockRowBit : sHighBit;
+            hin = advanceBlock(mPv[block], mMv[block], eq ? eq[block] : 0, hin, lastRowBit);
+        }
+        score += hin;
+        if (score < bestScore) {
+            bestScore = score;
+            firstBestPosition = position;
+        }
+        if (score == bestScore) {
+            lastBestPosition = position;
+        }
+        if (withinBound && score <= bound) {
+            if (withinBound->first < 0) {
+                withinBound->first = position;
+            }
+            withinBound->second = position;
+        }
+        if (score <= stopScore) {
+            break;
+        }
+    }
+    return {bestScore, preferLast ? lastBestPosition : firstBestPosition};
+}
+
+std::pair<int, int> ApproximateMatcher::versionPreservingMatch(const CompiledPattern &compiled, int begin, int end) const
+{
+    // column of the edit distance matrix, the start of the match is free
+    std::vector<int> column(compiled.length + 1);
+    column[0] = 0;
+    for (int row = 1; row <= compiled.length; ++row) {
+        column[row] = std::min(sForbidden, column[row - 1] + (compiled.version[row - 1] ? sForbidden : 1));
+    }
+    int bestDistance = sForbidden;
+    int bestPosition = -1;
+    for (int position = begin; position <= end; ++position) {
+        int diagonal = column[0];
+        for (int row = 1; row <= compiled.length; ++row) {
+            const bool version = compiled.version[row - 1];
+            const bool equal = compiled.tokenIds[row - 1] == mTextTokenIds[position];
+            const int substitution = diagonal + (equal ? 0 : (version ? sForbidden : 1));
+            const int deletion = column[row - 1] + (version ? sForbidden : 1);
+            const int insertion = column[row] + 1;
+            diagonal = column[row];
+            column[row] = std::min({substitution, deletion, insertion, sForbidden});
+        }
+        if (column[compiled.length] < bestDistance) {
+            bestDistance = column[compiled.length];
+            bestPosition = position;
+        }
+    }
+    return {bestDistance, bestPosition};
+}
+
+std::optional<ApproximateMatcher::Match> ApproximateMatcher::findMatch(const QString &pattern) const
+{
+    const CompiledPattern &compiled = compiledPattern(pattern);
+    if (compiled.length == 0 || mTextTokens.empty()) {
+        return {};
+    }
+    updateTextTokenIds();
+
+    const int maxErrors = static_cast<int>(compiled.length * mErrorRate);
+    const int textLength = static_cast<int>(mTextTokens.size());
+    std::pair<int, int> candidates {-1, -1};
+    auto [distance, lastToken] = search(compiled.forward, compiled.length, 0, textLength, 1, 0, false, maxErrors, &candidates);
+    if (lastToken < 0 || distance > maxErrors) {
+        return {};
+    }
+
+    // a changed version number changes the license, thus all ends of matches within the error bound
+    // are checked again without edits of version numbers
+    if (distance > 0 && compiled.hasVersion) {
+        const int begin = std::max(0, candidates.first - compiled.length - maxErrors);
+        std::tie(distance, lastToken) = versionPreservingMatch(compiled, begin, candidates.second);
+        if (lastToken < 0 || distance > maxErrors) {
+            return {};
+        }
+    }
+
+    // search reverse pattern backwards from the match end to recover the match start,
+    // preferring the longest of equally good matches
+    const int windowBegin = std::max(0, lastToken - compiled.length - maxErrors);
+    const auto reverseResult = search(compiled.reverse, compiled.length, lastToken, windowBegin - 1, -1, -1, true);
+    const int firstToken = reverseResult.second >= 0 ? reverseResult.second : windowBegin;
+
+    return Match {mTextTokens[firstToken].start, mTextTokens[lastToken].end - 1, distance};
+}
+
+std::optional<ApproximateMatcher::Match> ApproximateMatcher::findMatch(const QVector<QString> &patterns) const
+{
+    std::optional<Match> bestMatch;
+    for (const auto &pattern : patterns) {
+        auto match = findMatch(pattern);
+        if (match && (!bestMatch || match->distance < bestMatch->distance)) {
+            bestMatch = match;
+            if (bestMatch->distance == 0) {
+                break;
+            }
+        }
+    }
+    return bestMatch;
+}
@@ -0,0 +1,107 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef APPROXIMATEMATCHER_H
+#define APPROXIMATEMATCHER_H
+
+#include <QHash>
+#include <QString>
+#include "licensetokenizer.h"
+#include <QVector>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Approximate matcher for license headers on token level
+ *
+ * Texts and patterns are split into normalized tokens (see LicenseTokenizer). A pattern
+ * matches if some token sequence of the text can be transformed into the pattern with at most
+ * k token insertions, deletions or substitutions, where k is relative to the pattern length and
+ * rounded down, such that short patterns must match exactly. Version numbers of patterns, i.e. numbers
+ * after "version", "v" or license names like "GPL" and tokens like "v2", are never substituted or
+ * deleted. Other numbers, like those of addresses, are ordinary tokens. Matching uses Myers' bit-parallel algorithm
+ * with 64 pattern tokens per machine word.
+ */
+class ApproximateMatcher
+{
+public:
+    struct Match {
+        int start;  //!< position of first matched character in text
+        int end;    //!< position of last matched character in text
+        int distance; //!< token edit distance of the match
+    };
+
+    /**
+     * @param errorRate maximal number of token edits relative to the pattern token count
+     * @param maxTextTokens only the leading tokens of a text are considered for matching
+     */
+    explicit ApproximateMatcher(double errorRate = 0.08, int maxTextTokens = 4000);
+
+    /**
+     * @brief tokenize @p text that is used for all following findMatch() calls
+     */
+    void setText(const QString &text);
+
+    /**
+     * @brief obtain best match of any of the patterns in the text set by setText()
+     * @return match with smallest edit distance, if within the error bound
+     */
+    std::optional<Match> findMatch(const QVector<QString> &patterns) const;
+
+    std::optional<Match> findMatch(const QString &pattern) const;
+
+private:
+    struct Peq {
+        QHash<int, int> offsets; //!< token id to offset in blocks
+        std::vector<quint64> blocks;
+    };
+    struct CompiledPattern {
+        int length {0};
+        std::vector<int> tokenIds;
+        std::vector<bool> version; //!< pattern rows with version numbers, which must be matched exactly
+        bool hasVersion {false};
+        Peq forward;
+        Peq reverse;
+    };
+
+    const CompiledPattern &compiledPattern(const QString &pattern) const;
+    void updateTextTokenIds() const;
+    /**
+     * @brief run bit-parallel search over text tokens [begin, end) in direction @p step
+     * @param stopScore search stops as soon as the score is not larger
+     * @param preferLast if true, report the last instead of the first position with the best score
+     * @param withinBound if set, receives the first and last position with a score of at most @p bound
+     * @return best score and the token position at which it was reached
+     */
+    std::pair<int, int> search(const Peq &peq,
+                               int patternLength,
+                               int begin,
+                               int end,
+                               int step,
+                               int stopScore,
+                               bool preferLast,
+                               int bound = -1,
+                               std::pair<int, int> *withinBound = nullptr) const;
+    /**
+     * @brief best match ending within text tokens [begin, end] without substitutions or deletions of
+     *        version numbers
+     * @return edit distance and end position of the first best match
+     */
+    std::pair<int, int> versionPreservingMatch(const CompiledPattern &compiled, int begin, int end) const;
+
+    const double mErrorRate;
+    const int mMaxTextTokens;
+    QString mText;
+    std::vector<LicenseTokenizer::Token> mTextTokens;
+    mutable std::vector<int> mTextTokenIds;
+    mutable int mTextTokenIdsVocabularySize {-1};
+    mutable QHash<quint64, int> mVocabulary; //!< token hash to token id
+    mutable QHash<QString, CompiledPattern> mPatternCache;
+    mutable std::vector<quint64> mPv;
+    mutable std::vector<quint64> mMv;
+};
+
+#endif
@@ -0,0 +1,58 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "test_annotations.h"
+#include "../licenseregistry.h"
+#include "../pathsuffixmatcher.h"
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+void TestAnnotations::suffixMatcher()
+{
+    PathSuffixMatcher matcher;
+    QVERIFY(matcher.isEmpty());
+    matcher.addSuffix("kcompletion/tests/kcomboboxtest.cpp");
+    matcher.addSuffix("tests/kcomboboxtest.h");
+    matcher.addSuffix(""); // must not match everything
+    QVERIFY(!matcher.isEmpty());
+
+    QVERIFY(matcher.matches("/src/kcompletion/tests/kcomboboxtest.cpp"));
+    QVERIFY(matcher.matches("kcompletion/tests/kcomboboxtest.cpp"));
+    QVERIFY(matcher.matches("/src/other/tests/kcomboboxtest.h"));
+    QVERIFY(!matcher.matches("/src/kcompletion/tests/kcomboboxtest.cpp.orig"));
+    QVERIFY(!matcher.matches("/src/kcompletion/tests/kcomboboxtest.hpp"));
+    QVERIFY(!matcher.matches("/src/kcompletion/kcomboboxtest.cpp"));
+    QVERIFY(!matcher.matches(""));
+}
+
+void TestAnnotations::projectLocalAnnotations()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    {
+        QFile file(dir.filePath("missing-headers-blacklist.txt"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("project/src/noheader.cpp\nproject/src/generated.h\n\n");
+    }
+    {
+        QFile file(dir.filePath("generated-files.txt"));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("project/src/generated.h\n");
+    }
+
+    LicenseRegistry registry;
+    QVERIFY(registry.annotatedMissingLicense("/home/user/project/src/noheader.cpp").isEmpty());
+    QVERIFY(registry.loadAnnotations(dir.path()));
+    QCOMPARE(registry.annotatedMissingLicense("/home/user/project/src/noheader.cpp"), LicenseRegistry::MissingLicense);
+    QCOMPARE(registry.annotatedMissingLicense("/home/user/project/src/generated.h"), LicenseRegistry::MissingLicenseForGeneratedFile);
+    QVERIFY(registry.annotatedMissingLicense("/home/user/project/src/header.cpp").isEmpty());
+
+    QTemporaryDir emptyDir;
+    QVERIFY(!registry.loadAnnotations(emptyDir.path()));
+}
+
+QTEST_GUILESS_MAIN(TestAnnotations);
@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef TEST_ANNOTATIONS_H
+#define TEST_ANNOTATIONS_H
+
+#include <QObject>
+
+class TestAnnotations : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void suffixMatcher();
+    void projectLocalAnnotations();
+};
+#endif
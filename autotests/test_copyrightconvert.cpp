@@ -7,6 +7,7 @@
 #include "test_copyrightconvert.h"
 #include "../licenseregistry.h"
 #include "../directoryparser.h"
+#include "../copyrightscanner.h"
 #include <QTest>
 #include <QDebug>
 #include <QDir>
@@ -63,6 +64,15 @@ void TestCopyrightConvert::detectCopyright()
         QCOMPARE(years, example.years);
         QCOMPARE(name, example.name);
         QCOMPARE(contact, example.contact);
+
+        // scanner must find the same statement
+        const auto statement = CopyrightScanner::findNext(example.text);
+        QVERIFY(statement);
+        QCOMPARE(statement->start, match.capturedStart());
+        QCOMPARE(statement->end, match.capturedEnd());
+        QCOMPARE(example.text.mid(statement->years.start, statement->years.length), match.captured("years"));
+        QCOMPARE(example.text.mid(statement->name.start, statement->name.length), name);
+        QCOMPARE(example.text.mid(statement->contact.start, statement->contact.length), contact);
     }
 }
 
@@ -125,6 +135,53 @@ void TestCopyrightConvert::skipSourceCodeStrings()
     QCOMPARE(header, originalHeader);
 }
 
+void TestCopyrightConvert::convertManyAuthorsHeader_data()
+{
+    // several sizes, such that non-linear growth of the conversion time is visible
+    QTest::addColumn<int>("authors");
+    QTest::newRow("500 authors") << 500;
+    QTest::newRow("2000 authors") << 2000;
+    QTest::newRow("8000 authors") << 8000;
+}
+
+void TestCopyrightConvert::convertManyAuthorsHeader()
+{
+    QFETCH(int, authors);
+    QString originalHeader = "/*\n";
+    QString targetHeader = "/*\n";
+    for (int i = 0; i < authors; ++i) {
+        originalHeader += QString(" * Copyright (C) 2010 - 2016 by Jane Doe <mail%1@example.com>\n * @author John Doe <mail%1@example.com>\n").arg(i);
+        targetHeader += QString(" * SPDX-FileCopyrightText: 2010-2016 Jane Doe <mail%1@example.com>\n * @author John Doe <mail%1@example.com>\n").arg(i);
+    }
+    originalHeader += " */\n";
+    targetHeader += " */\n";
+
+    DirectoryParser parser;
+    QString header;
+    QBENCHMARK {
+        header = parser.unifyCopyrightStatements(originalHeader);
+    }
+    QCOMPARE(header.count("SPDX-FileCopyrightText:"), authors);
+    QCOMPARE(header, targetHeader);
+}
+
+void TestCopyrightConvert::collectCopyrightStatements()
+{
+    const QString content =
+            "/*\n"
+            " * Copyright  2018,2019   John Doe   <mail@example.com>\n"
+            " * SPDX-FileCopyrightText: 2020 Jane Doe\n"
+            " */\n"
+            "const char *text = \"Copyright 2021 Nobody\";\n";
+
+    DirectoryParser parser;
+    QCOMPARE(parser.copyrightStatements(content), QStringList({"2018, 2019 John Doe <mail@example.com>", "2020 Jane Doe"}));
+    QCOMPARE(parser.copyrightStatements("int main() {}"), QStringList());
+    // tag values are unified the same way, in file order with all other statements
+    QCOMPARE(parser.copyrightStatements("// SPDX-FileCopyrightText:  2001,2002   the KMime authors\n// Copyright 2003 John Doe\n"),
+             QStringList({"2001, 2002 the KMime authors", "2003 John Doe"}));
+}
+
 void TestCopyrightConvert::prettyPrintCopyrightComment()
 {
     const QString originalHeader =
@@ -145,6 +202,28 @@ void TestCopyrightConvert::prettyPrintCopyrightComment()
     QCOMPARE(header, targetHeader);
 }
 
+void TestCopyrightConvert::prettyPrintKeepsFileBody()
+{
+    const QString body =
+            "\n"
+            "/**\n"
+            " * Documentation comment   *\n"
+            " */\n"
+            "int value = 2 * 3; \n";
+    const QString originalHeader =
+            "/***************************\n"
+            " * SPDX-FileCopyrightText: 2018 John Doe <mail@example.com>   *\n"
+            " * SPDX-License-Identifier: GPL-2.0-or-later */\n";
+    const QString targetHeader =
+            "/*\n"
+            "    SPDX-FileCopyrightText: 2018 John Doe <mail@example.com>\n"
+            "    SPDX-License-Identifier: GPL-2.0-or-later*/\n";
+
+    DirectoryParser parser;
+    QCOMPARE(parser.unifyCopyrightCommentHeader(originalHeader + body), targetHeader + body);
+    QCOMPARE(parser.unifyCopyrightCommentHeader("/* single line */" + body), "/* single line */" + body);
+}
+
 void TestCopyrightConvert::doNotConvertCopyrightKeyworsInCode()
 {
     const QString originalSnippet =
@@ -22,9 +22,13 @@ private Q_SLOTS:
     void convertSingleCopyrightStatement();
     void convertFullHeader();
     void skipSourceCodeStrings();
+    void convertManyAuthorsHeader_data();
+    void convertManyAuthorsHeader();
+    void collectCopyrightStatements();
 
     // convert copyright comments
     void prettyPrintCopyrightComment();
+    void prettyPrintKeepsFileBody();
 
     // do not convert statements in code
     void doNotConvertCopyrightKeyworsInCode();
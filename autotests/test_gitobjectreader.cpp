@@ -0,0 +1,152 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "test_gitobjectreader.h"
+#include "../directoryparser.h"
+#include "../gitobjectreader.h"
+#include <QDir>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTest>
+#include <algorithm>
+
+bool TestGitObjectReader::git(const QStringList &arguments)
+{
+    QProcess process;
+    process.setWorkingDirectory(mRepository.path());
+    process.start(QStringLiteral("git"),
+                  QStringList({"-c", "user.name=Test", "-c", "user.email=test@example.com", "-c", "commit.gpgsign=false", "-c", "tag.gpgsign=false"}) + arguments);
+    return process.waitForFinished() && process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+}
+
+QString TestGitObjectReader::fileContent(int version) const
+{
+    // large and similar contents, such that packing stores the later version as delta
+    QString content("// SPDX-License-Identifier: MIT\n");
+    for (int i = 0; i < 200; ++i) {
+        content += QString("int function%1() { return %2; }\n").arg(i).arg(i == 100 ? version : i);
+    }
+    return content;
+}
+
+void TestGitObjectReader::writeFile(const QString &path, const QByteArray &content)
+{
+    QDir(mRepository.path()).mkpath(QFileInfo(mRepository.filePath(path)).path());
+    QFile file(mRepository.filePath(path));
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(content);
+}
+
+void TestGitObjectReader::initTestCase()
+{
+    if (QStandardPaths::findExecutable("git").isEmpty()) {
+        QSKIP("git is needed to create test repositories");
+    }
+    QVERIFY(mRepository.isValid());
+    QVERIFY(git({"init", "--quiet"}));
+    writeFile("src/main.cpp", fileContent(1).toUtf8());
+    writeFile("src/unlicensed.cpp", "int main() { return 0; }\n");
+    writeFile("README.md", "readme\n");
+    QVERIFY(git({"add", "."}));
+    QVERIFY(git({"commit", "--quiet", "-m", "first"}));
+    QVERIFY(git({"tag", "-a", "-m", "release", "v1.0"}));
+
+    writeFile("src/main.cpp", fileContent(2).toUtf8());
+    writeFile("src/lib/other.h", "// SPDX-License-Identifier: BSD-2-Clause\n");
+    QVERIFY(git({"add", "."}));
+    QVERIFY(git({"commit", "--quiet", "-m", "second"}));
+    QVERIFY(git({"branch", "release/2.0"}));
+}
+
+void TestGitObjectReader::readLooseObjects()
+{
+    GitObjectReader reader(mRepository.path());
+    QVERIFY(reader.open());
+
+    const QByteArray tag = reader.resolveRevision("v1.0");
+    QCOMPARE(tag.size(), 20);
+    QCOMPARE(reader.readObject(tag).type, GitObjectReader::ObjectType::TAG);
+    const QByteArray tree = reader.peelToTree(tag);
+    QVERIFY(!tree.isEmpty());
+
+    QVector<GitObjectReader::BlobEntry> blobs;
+    QVERIFY(reader.listBlobs(tree, &blobs));
+    QStringList paths;
+    for (const auto &blob : blobs) {
+        paths.append(blob.path);
+    }
+    QCOMPARE(paths, QStringList({"README.md", "src/main.cpp", "src/unlicensed.cpp"}));
+    const auto blob = reader.readObject(blobs.at(1).id);
+    QCOMPARE(blob.type, GitObjectReader::ObjectType::BLOB);
+    QCOMPARE(blob.data, fileContent(1).toUtf8());
+
+    QCOMPARE(reader.resolveRevision("HEAD"), reader.resolveRevision("release/2.0"));
+    QVERIFY(reader.resolveRevision("v3.0").isEmpty());
+    QVERIFY(!reader.errorString().isEmpty());
+}
+
+void TestGitObjectReader::readPackedObjects()
+{
+    // -f recomputes deltas, thus one version of main.cpp is stored as delta of the other one
+    QVERIFY(git({"repack", "-a", "-d", "-f", "--quiet"}));
+    QVERIFY(git({"pack-refs", "--all"}));
+    QVERIFY(!QDir(mRepository.filePath(".git/objects/pack")).entryList({"*.idx"}).isEmpty());
+
+    GitObjectReader reader(mRepository.path());
+    QVERIFY(reader.open());
+    for (const QString &revision : {"v1.0", "release/2.0"}) {
+        const QByteArray tree = reader.peelToTree(reader.resolveRevision(revision));
+        QVERIFY(!tree.isEmpty());
+        QVector<GitObjectReader::BlobEntry> blobs;
+        QVERIFY(reader.listBlobs(tree, &blobs));
+        const auto iter = std::find_if(blobs.cbegin(), blobs.cend(), [](const GitObjectReader::BlobEntry &blob) {
+            return blob.path == "src/main.cpp";
+        });
+        QVERIFY(iter != blobs.cend());
+        QCOMPARE(reader.readObject(iter->id).data, fileContent(revision == "v1.0" ? 1 : 2).toUtf8());
+    }
+}
+
+void TestGitObjectReader::readAlternateObjects()
+{
+    // a shared clone stores no objects of its own but refers to the original repository in objects/info/alternates
+    QTemporaryDir clone;
+    QVERIFY(clone.isValid());
+    QVERIFY(git({"clone", "--quiet", "--shared", mRepository.path(), clone.filePath("shared")}));
+    QVERIFY(QFileInfo::exists(clone.filePath("shared/.git/objects/info/alternates")));
+
+    GitObjectReader reader(clone.filePath("shared"));
+    QVERIFY(reader.open());
+    const QByteArray tree = reader.peelToTree(reader.resolveRevision("v1.0"));
+    QVERIFY(!tree.isEmpty());
+    QVector<GitObjectReader::BlobEntry> blobs;
+    QVERIFY(reader.listBlobs(tree, &blobs));
+    QCOMPARE(blobs.size(), 3);
+    QCOMPARE(reader.readObject(blobs.at(1).id).data, fileContent(1).toUtf8());
+}
+
+void TestGitObjectReader::parseGitRevision()
+{
+    DirectoryParser parser;
+    const auto firstResults = parser.parseGitRevision(mRepository.path(), "v1.0");
+    QCOMPARE(firstResults.size(), 2);
+    QCOMPARE(firstResults.value("v1.0:src/main.cpp"), "MIT");
+    QCOMPARE(firstResults.value("v1.0:src/unlicensed.cpp"), LicenseRegistry::UnknownLicense);
+
+    // unchanged blobs are reported with memoized verdicts
+    const auto secondResults = parser.parseGitRevision(mRepository.path(), "release/2.0");
+    QCOMPARE(secondResults.size(), 3);
+    QCOMPARE(secondResults.value("release/2.0:src/main.cpp"), "MIT");
+    QCOMPARE(secondResults.value("release/2.0:src/unlicensed.cpp"), LicenseRegistry::UnknownLicense);
+    QCOMPARE(secondResults.value("release/2.0:src/lib/other.h"), "BSD-2-Clause");
+    QVERIFY(parser.errorString().isEmpty());
+
+    // unknown revisions are errors, not empty revisions
+    QVERIFY(parser.parseGitRevision(mRepository.path(), "unknown-revision").isEmpty());
+    QVERIFY(!parser.errorString().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestGitObjectReader);
@@ -0,0 +1,31 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef TEST_GITOBJECTREADER_H
+#define TEST_GITOBJECTREADER_H
+
+#include <QObject>
+#include <QTemporaryDir>
+
+class TestGitObjectReader : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void readLooseObjects();
+    void readPackedObjects();
+    void readAlternateObjects();
+    void parseGitRevision();
+
+private:
+    bool git(const QStringList &arguments);
+    QString fileContent(int version) const;
+    void writeFile(const QString &path, const QByteArray &content);
+
+    QTemporaryDir mRepository;
+};
+#endif
@@ -8,10 +8,21 @@
 #include "../licenseregistry.h"
 #include "../directoryparser.h"
 #include "../skipparser.h"
+#include "../approximatematcher.h"
+#include "../tokenmatcher.h"
+#include "../similarityindex.h"
+#include "../headerverdictcache.h"
+#include "../licensewatcher.h"
+#include "../progressreporter.h"
+#include "../spdxtagscanner.h"
+#include <QSignalSpy>
 #include <QTest>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QTemporaryDir>
+#include <thread>
+#include <vector>
 
 void TestHeaderDetection::detectForIdentifierRegExpParser(const QString &spdxMarker)
 {
@@ -74,148 +85,198 @@ void TestHeaderDetection::detectForIdentifierSkipParser(const QString &spdxMarke
     }
 }
 
+void TestHeaderDetection::detectForIdentifierTokenParser(const QString &spdxMarker)
+{
+    const QString testdataDir { ":/testdata/" + spdxMarker };
+
+    LicenseRegistry registry;
+    const TokenMatcher &matcher = registry.tokenMatcher();
+    QVERIFY(QDir().exists(testdataDir));
+    QDirIterator testdataIter(testdataDir);
+    while (testdataIter.hasNext()) {
+        QFile file(testdataIter.next());
+        file.open(QIODevice::ReadOnly);
+        const QString fileContents { file.readAll() };
+        QVERIFY(!fileContents.isEmpty());
+
+        bool result = false;
+        const auto matches = matcher.findMatches(fileContents);
+        for (const auto &match : matches) {
+            result |= matcher.expression(match.templateIndex) == spdxMarker;
+        }
+        if (!result) {
+            qWarning() << "Could not detect" << spdxMarker << ":" << testdataIter.filePath();
+        }
+        QVERIFY(result);
+    }
+}
+
 void TestHeaderDetection::detectAGPL30orlater()
 {
     detectForIdentifierRegExpParser("AGPL-3.0-or-later");
     detectForIdentifierSkipParser("AGPL-3.0-or-later");
+    detectForIdentifierTokenParser("AGPL-3.0-or-later");
 }
 
 void TestHeaderDetection::detectLGPL20orlater()
 {
     detectForIdentifierRegExpParser("LGPL-2.0-or-later");
     detectForIdentifierSkipParser("LGPL-2.0-or-later");
+    detectForIdentifierTokenParser("LGPL-2.0-or-later");
 }
 
 void TestHeaderDetection::detectLGPL21orlater()
 {
     detectForIdentifierRegExpParser("LGPL-2.1-or-later");
     detectForIdentifierSkipParser("LGPL-2.1-or-later");
+    detectForIdentifierTokenParser("LGPL-2.1-or-later");
 }
 
 void TestHeaderDetection::detectLGPL20only()
 {
     detectForIdentifierRegExpParser("LGPL-2.0-only");
     detectForIdentifierSkipParser("LGPL-2.0-only");
+    detectForIdentifierTokenParser("LGPL-2.0-only");
 }
 
 void TestHeaderDetection::detectLGPL21onlyOrLGPL30only()
 {
     detectForIdentifierRegExpParser("LGPL-2.1-only_OR_LGPL-3.0-only");
     detectForIdentifierSkipParser("LGPL-2.1-only_OR_LGPL-3.0-only");
+    detectForIdentifierTokenParser("LGPL-2.1-only_OR_LGPL-3.0-only");
 }
 
 void TestHeaderDetection::detectLGPL20onlyWithQtCommercialException()
 {
     detectForIdentifierRegExpParser("LGPL-2.0-only_WITH_Qt-Commercial-exception-1.0");
     detectForIdentifierSkipParser("LGPL-2.0-only_WITH_Qt-Commercial-exception-1.0");
+    detectForIdentifierTokenParser("LGPL-2.0-only_WITH_Qt-Commercial-exception-1.0");
 }
 
 void TestHeaderDetection::detectGPL20only()
 {
     detectForIdentifierRegExpParser("GPL-2.0-only");
     detectForIdentifierSkipParser("GPL-2.0-only");
+    detectForIdentifierTokenParser("GPL-2.0-only");
 }
 
 void TestHeaderDetection::detectGPL20orlater()
 {
     detectForIdentifierRegExpParser("GPL-2.0-or-later");
     detectForIdentifierSkipParser("GPL-2.0-or-later");
+    detectForIdentifierTokenParser("GPL-2.0-or-later");
 }
 
 void TestHeaderDetection::detectGPL30orlater()
 {
     detectForIdentifierRegExpParser("GPL-3.0-or-later");
     detectForIdentifierSkipParser("GPL-3.0-or-later");
+    detectForIdentifierTokenParser("GPL-3.0-or-later");
 }
 
 void TestHeaderDetection::detectGPL2orlaterwithQtCommercialException()
 {
     detectForIdentifierRegExpParser("GPL-2.0-or-later_WITH_Qt-Commercial-exception-1.0");
     detectForIdentifierSkipParser("GPL-2.0-or-later_WITH_Qt-Commercial-exception-1.0");
+    detectForIdentifierTokenParser("GPL-2.0-or-later_WITH_Qt-Commercial-exception-1.0");
 }
 
 void TestHeaderDetection::detectGPL30_or_KDE()
 {
     detectForIdentifierRegExpParser("GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL");
     detectForIdentifierSkipParser("GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL");
+    detectForIdentifierTokenParser("GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL");
 }
 
 void TestHeaderDetection::detectGPL20_or_GPL30_or_KDE()
 {
     detectForIdentifierRegExpParser("GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL");
     detectForIdentifierSkipParser("GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL");
+    detectForIdentifierTokenParser("GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL");
 }
 
 void TestHeaderDetection::detectLGPL21only()
 {
     detectForIdentifierRegExpParser("LGPL-2.1-only");
     detectForIdentifierSkipParser("LGPL-2.1-only");
+    detectForIdentifierTokenParser("LGPL-2.1-only");
 }
 
 void TestHeaderDetection::detectLGPL20_or_LGPL30()
 {
     detectForIdentifierRegExpParser("LGPL-2.0-only_OR_LGPL-3.0-only");
     detectForIdentifierSkipParser("LGPL-2.0-only_OR_LGPL-3.0-only");
+    detectForIdentifierTokenParser("LGPL-2.0-only_OR_LGPL-3.0-only");
 }
 
 void TestHeaderDetection::detectLGPL21_or_LGPL30_or_KDE()
 {
     detectForIdentifierRegExpParser("LGPL-2.1-only_OR_LGPL-3.0-only_OR_LicenseRef-KDE-Accepted-LGPL");
     detectForIdentifierSkipParser("LGPL-2.1-only_OR_LGPL-3.0-only_OR_LicenseRef-KDE-Accepted-LGPL");
+    detectForIdentifierTokenParser("LGPL-2.1-only_OR_LGPL-3.0-only_OR_LicenseRef-KDE-Accepted-LGPL");
 }
 
 void TestHeaderDetection::detectLGPL30orlater()
 {
     detectForIdentifierRegExpParser("LGPL-3.0-or-later");
     detectForIdentifierSkipParser("LGPL-3.0-or-later");
+    detectForIdentifierTokenParser("LGPL-3.0-or-later");
 }
 
 void TestHeaderDetection::detectLGPL30onlyOrGPL20orlater()
 {
     detectForIdentifierRegExpParser("LGPL-3.0-only_OR_GPL-2.0-or-later");
     detectForIdentifierSkipParser("LGPL-3.0-only_OR_GPL-2.0-or-later");
+    detectForIdentifierTokenParser("LGPL-3.0-only_OR_GPL-2.0-or-later");
 }
 
 void TestHeaderDetection::detectBSD2Clause()
 {
     detectForIdentifierRegExpParser("BSD-2-Clause");
     detectForIdentifierSkipParser("BSD-2-Clause");
+    detectForIdentifierTokenParser("BSD-2-Clause");
 }
 
 void TestHeaderDetection::detectBSD3Clause()
 {
     detectForIdentifierRegExpParser("BSD-3-Clause");
     detectForIdentifierSkipParser("BSD-3-Clause");
+    detectForIdentifierTokenParser("BSD-3-Clause");
 }
 
 void TestHeaderDetection::detectMIT()
 {
     detectForIdentifierRegExpParser("MIT");
     detectForIdentifierSkipParser("MIT");
+    detectForIdentifierTokenParser("MIT");
 }
 
 void TestHeaderDetection::detectX11()
 {
     detectForIdentifierRegExpParser("X11");
     detectForIdentifierSkipParser("X11");
+    detectForIdentifierTokenParser("X11");
 }
 
 void TestHeaderDetection::detectLGPL21withQtLGPLexception_or_QtCommercial()
 {
     detectForIdentifierRegExpParser("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LicenseRef-Qt-Commercial");
     detectForIdentifierSkipParser("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LicenseRef-Qt-Commercial");
+    detectForIdentifierTokenParser("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LicenseRef-Qt-Commercial");
 }
 
 void TestHeaderDetection::detectLGPL21withQtLGPLexceptionOrLGPL30withQtLGPLexception()
 {
     detectForIdentifierRegExpParser("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LGPL-3.0-only_WITH_Qt-LGPL-exception-1.1_OR_LicenseRef-Qt-Commercial");
     detectForIdentifierSkipParser("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LGPL-3.0-only_WITH_Qt-LGPL-exception-1.1_OR_LicenseRef-Qt-Commercial");
+    detectForIdentifierTokenParser("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LGPL-3.0-only_WITH_Qt-LGPL-exception-1.1_OR_LicenseRef-Qt-Commercial");
 }
 
 void TestHeaderDetection::detectLGPL30_or_GPL20_or_GPL30_or_GPLKFQF_or_QtCommercial()
 {
     detectForIdentifierRegExpParser("LGPL-3.0-only_OR_GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KFQF-Accepted-GPL_OR_LicenseRef-Qt-Commercial");
     detectForIdentifierSkipParser("LGPL-3.0-only_OR_GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KFQF-Accepted-GPL_OR_LicenseRef-Qt-Commercial");
+    detectForIdentifierTokenParser("LGPL-3.0-only_OR_GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KFQF-Accepted-GPL_OR_LicenseRef-Qt-Commercial");
 }
 
 void TestHeaderDetection::detectSpdxExpressions()
@@ -236,4 +297,498 @@ void TestHeaderDetection::detectSpdxExpressions()
     QCOMPARE(results.first(), "GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL");
 }
 
+void TestHeaderDetection::spdxTagScanner()
+{
+    const QString fileContents {
+        "/* SPDX-FileCopyrightText: 2020 Jane Doe <jane@example.com> */\r\n"
+        "// SPDX-License-Identifier: MIT OR BSL-1.0\n"
+        "// SPDX-License-Identifier:\n"
+        "<!-- SPDX-License-Identifier: GPL-2.0-or-later -->\n"
+        "# SPDX-Unknown-Tag: foo\n"};
+
+    const auto statements = SpdxTagScanner::findAll(fileContents);
+    QCOMPARE(statements.size(), 3);
+    QCOMPARE(statements.at(0).tag, SpdxTagScanner::Tag::FILE_COPYRIGHT_TEXT);
+    QCOMPARE(fileContents.mid(statements.at(0).valueStart, statements.at(0).valueLength), "2020 Jane Doe <jane@example.com>");
+    QCOMPARE(fileContents.mid(statements.at(1).valueStart, statements.at(1).valueLength), "MIT OR BSL-1.0");
+    QCOMPARE(fileContents.mid(statements.at(2).valueStart, statements.at(2).valueLength), "GPL-2.0-or-later");
+
+    DirectoryParser parser;
+    const auto tags = parser.spdxTags(fileContents);
+    QCOMPARE(tags.licenseExpressions, QStringList({"MIT OR BSL-1.0", "GPL-2.0-or-later"}));
+    QCOMPARE(tags.copyrightTexts, QStringList({"2020 Jane Doe <jane@example.com>"}));
+    QCOMPARE(parser.detectSpdxLicenseStatement(fileContents), "(MIT_OR_BSL-1.0)_AND_GPL-2.0-or-later");
+
+    // only file headers are checked
+    const QString lateStatement = QString(SpdxTagScanner::sDefaultWindowSize, QLatin1Char(' ')) + "SPDX-License-Identifier: MIT\n";
+    QVERIFY(SpdxTagScanner::findAll(lateStatement).isEmpty());
+    QCOMPARE(SpdxTagScanner::findAll(lateStatement, lateStatement.size()).size(), 1);
+}
+
+void TestHeaderDetection::approximateMatcher()
+{
+    ApproximateMatcher matcher(0.4);
+    matcher.setText("// alpha beta gamma delta epsilon zeta\n// eta theta");
+
+    { // exact match over comment markers and line breaks
+        auto match = matcher.findMatch(QString("zeta eta"));
+        QVERIFY(match);
+        QCOMPARE(match->distance, 0);
+        QCOMPARE(match->start, 34);
+        QCOMPARE(match->end, 44);
+    }
+    { // tokens are compared case-insensitively
+        auto match = matcher.findMatch(QString("BETA Gamma"));
+        QVERIFY(match);
+        QCOMPARE(match->distance, 0);
+    }
+    { // one substituted token
+        auto match = matcher.findMatch(QString("beta gamme delta epsilon"));
+        QVERIFY(match);
+        QCOMPARE(match->distance, 1);
+        QCOMPARE(match->start, 9);
+        QCOMPARE(match->end, 32);
+    }
+    { // one missing and one additional token
+        auto match = matcher.findMatch(QString("beta delta epsilon omega zeta"));
+        QVERIFY(match);
+        QCOMPARE(match->distance, 2);
+        QCOMPARE(match->start, 9);
+        QCOMPARE(match->end, 37);
+    }
+    { // too many edits
+        auto match = matcher.findMatch(QString("alpha one two three"));
+        QVERIFY(!match);
+    }
+    { // best of multiple patterns
+        auto match = matcher.findMatch(QVector<QString> {"alpha one gamma delta", "alpha beta gamma delta"});
+        QVERIFY(match);
+        QCOMPARE(match->distance, 0);
+    }
+    { // short patterns must match exactly
+        auto match = matcher.findMatch(QString("beta gamme"));
+        QVERIFY(!match);
+    }
+    { // version numbers are neither substituted nor deleted
+        ApproximateMatcher versionMatcher(0.4);
+        versionMatcher.setText("licensed under the GNU GPL v2 terms");
+        QVERIFY(!versionMatcher.findMatch(QString("licensed under the GNU GPL v3 terms")));
+        QVERIFY(!versionMatcher.findMatch(QString("licensed under GNU GPL v2 version 3 terms")));
+        auto match = versionMatcher.findMatch(QString("licensed under GNU GPL v2 terms"));
+        QVERIFY(match);
+        QCOMPARE(match->distance, 1);
+    }
+    { // other numbers are ordinary tokens
+        ApproximateMatcher addressMatcher(0.4);
+        addressMatcher.setText("Free Software Foundation, Inc., 59 Franklin Street, Fifth Floor");
+        auto match = addressMatcher.findMatch(QString("Foundation Inc 51 Franklin Street Fifth Floor"));
+        QVERIFY(match);
+        QCOMPARE(match->distance, 1);
+    }
+    { // later matches are considered, if the best match changes a version
+        const QString text("licensed under the GNU GPL v3 terms and licensed under a GNU GPL v2 terms");
+        ApproximateMatcher versionMatcher(0.4);
+        versionMatcher.setText(text);
+        auto match = versionMatcher.findMatch(QString("licensed under the GNU GPL v2 terms"));
+        QVERIFY(match);
+        QCOMPARE(match->distance, 1);
+        QCOMPARE(match->start, text.lastIndexOf("licensed"));
+    }
+}
+
+void TestHeaderDetection::tokenMatcher()
+{
+    TokenMatcher matcher;
+    QCOMPARE(matcher.addTemplate("A", "This library is free software; you can redistribute it."), 0);
+    QCOMPARE(matcher.addTemplate("B", "This library is free software,\nyou may not redistribute it."), 1);
+    matcher.finalize();
+    QCOMPARE(matcher.templateCount(), 2);
+
+    { // reflowed, different case and punctuation
+        const QString text = "/*\n * this Library is\n * FREE software you can\n * redistribute it\n */";
+        const auto matches = matcher.findMatches(text);
+        QCOMPARE(matches.count(), 1);
+        QCOMPARE(matches.first().templateIndex, 0);
+        QCOMPARE(matcher.expression(matches.first().templateIndex), "A");
+        QCOMPARE(matches.first().start, text.indexOf("this"));
+        QCOMPARE(matches.first().end, text.indexOf("it\n") + 1);
+    }
+    { // unknown token inside of template
+        const auto matches = matcher.findMatches("This library is free software; you really can redistribute it.");
+        QVERIFY(matches.isEmpty());
+    }
+    { // both templates
+        const auto matches = matcher.findMatches("this library is free software you may not redistribute it. "
+                                                 "this library is free software you can redistribute it");
+        QCOMPARE(matches.count(), 2);
+    }
+}
+
+void TestHeaderDetection::similarityIndex()
+{
+    SimilarityIndex index;
+    index.addTemplate("A", "Permission is hereby granted to use copy modify merge publish and distribute this software "
+                           "for any purpose provided that the above notice appears in all copies of the software");
+    index.addTemplate("B", "Redistribution of the library in source or binary form must retain the list of conditions "
+                           "stated in the accompanying documentation and the following disclaimer of all warranties");
+
+    { // one changed word in comment block
+        const auto match = index.findNearest(u"/* Permission is hereby granted to use copy modify merge publish and distribute this software\n"
+                                             u" * for any purpose provided that the notice above appears in all copies of the software */");
+        QVERIFY(match);
+        QCOMPARE(match->expression, "A");
+        QVERIFY(match->similarity > 0.5);
+        QVERIFY(match->similarity < 1.0);
+    }
+    { // unrelated text
+        QVERIFY(!index.findNearest(u"import QtQuick 2.1\nItem { id: root; width: 100; height: 200 }"));
+    }
+    { // leading comment extraction
+        QCOMPARE(DirectoryParser::leadingComment(u"\n/* head */\nint main() {}").toString(), QString("/* head */"));
+        QCOMPARE(DirectoryParser::leadingComment(u"# one\n  # two\nfoo = 1\n").toString(), QString("# one\n  # two\n"));
+    }
+
+    QFile file(":/testdata/LGPL-2.0-or-later/AboutPage.qml");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QString fileContents = file.readAll();
+    fileContents.replace("redistribute", "share");
+
+    DirectoryParser parser;
+    QVERIFY(parser.detectLicenses(fileContents).isEmpty());
+    const auto suggestion = parser.suggestLicense(fileContents);
+    QVERIFY(suggestion);
+    QVERIFY(suggestion->expression.startsWith("LGPL-"));
+}
+
+void TestHeaderDetection::headerDeduplication()
+{
+    QFile file(":/testdata/LGPL-2.0-or-later/AboutPage.qml");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QString fileContents = file.readAll();
+    QString otherAuthorContents = fileContents;
+    otherAuthorContents.replace("Copyright (C) 2018 Aleix Pol Gonzalez <aleixpol@blue-systems.com>", "SPDX-FileCopyrightText: 2020 Jane Doe <jane@example.com>");
+    QVERIFY(otherAuthorContents != fileContents);
+
+    QString window;
+    QString otherAuthorWindow;
+    HeaderVerdictCache::headerWindow(DirectoryParser::leadingComment(fileContents), window);
+    HeaderVerdictCache::headerWindow(DirectoryParser::leadingComment(otherAuthorContents), otherAuthorWindow);
+    QVERIFY(!window.contains("Aleix"));
+    QVERIFY(window.contains("Franklin Street"));
+    QCOMPARE(window, otherAuthorWindow);
+
+    HeaderVerdictCache cache;
+    const quint64 fingerprint = HeaderVerdictCache::fingerprint(window);
+    QVERIFY(!cache.lookup(fingerprint, window));
+    cache.insert(fingerprint, window, {"LGPL-2.0-or-later"});
+    QCOMPARE(cache.lookup(fingerprint, otherAuthorWindow), HeaderVerdictCache::Verdict {"LGPL-2.0-or-later"});
+    // same fingerprint but different window must not be reused
+    QVERIFY(!cache.lookup(fingerprint, u"some other window"));
+    QCOMPARE(cache.size(), 1);
+
+    // content outside of leading comments is only skipped if it cannot contain any header text
+    LicenseRegistry registry;
+    for (const auto &expression : registry.expressions()) {
+        for (const auto &header : registry.headerTexts(expression)) {
+            QVERIFY2(HeaderVerdictCache::containsLicenseMarker(header), qPrintable(expression + ": " + header));
+        }
+    }
+    QVERIFY(HeaderVerdictCache::containsLicenseMarker(u"// SPDX-License-Identifier: MIT"));
+    QVERIFY(!HeaderVerdictCache::containsLicenseMarker(u"int main() { return 0; }"));
+
+    QFile mitFile(":/testdata/MIT/prison.cpp");
+    QVERIFY(mitFile.open(QIODevice::ReadOnly));
+    const QString mitContents = mitFile.readAll();
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    // licenses after the leading comment must be detected also if the header window is reused
+    const QVector<QPair<QString, QString>> files {{"a.qml", fileContents},
+                                                  {"b.qml", otherAuthorContents},
+                                                  {"c.qml", "// no license\n" + fileContents},
+                                                  {"d.qml", fileContents + "\n" + mitContents},
+                                                  {"e.qml", fileContents + "\n// SPDX-License-Identifier: MIT\n"}};
+    for (const auto &entry : files) {
+        QFile output(directory.filePath(entry.first));
+        QVERIFY(output.open(QIODevice::WriteOnly));
+        output.write(entry.second.toUtf8());
+    }
+    for (bool deduplication : {true, false}) {
+        DirectoryParser parser;
+        parser.setHeaderDeduplication(deduplication);
+        const auto results = parser.parseAll(directory.path());
+        QCOMPARE(results.count(), 5);
+        for (auto iter = results.constBegin(); iter != results.constEnd(); ++iter) {
+            const bool multiLicense = iter.key().endsWith("d.qml") || iter.key().endsWith("e.qml");
+            QCOMPARE(iter.value(), multiLicense ? LicenseRegistry::AmbigiousLicense : QString("LGPL-2.0-or-later"));
+        }
+    }
+}
+
+void TestHeaderDetection::shardedParsing()
+{
+    QCOMPARE(DirectoryParser::shardOf(u"src/main.cpp", 1), 0);
+    QCOMPARE(DirectoryParser::shardOf(u"src/main.cpp", 7), DirectoryParser::shardOf(u"src/main.cpp", 7));
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    QVERIFY(QDir(directory.path()).mkdir("src"));
+    for (int i = 0; i < 20; ++i) {
+        QFile output(directory.filePath(QString("src/file%1.cpp").arg(i)));
+        QVERIFY(output.open(QIODevice::WriteOnly));
+        output.write("// SPDX-License-Identifier: MIT\n");
+    }
+
+    DirectoryParser parser;
+    const auto allResults = parser.parseAll(directory.path());
+    QCOMPARE(allResults.count(), 20);
+
+    QMap<QString, LicenseRegistry::SpdxExpression> shardedResults;
+    for (int shard = 0; shard < 3; ++shard) {
+        parser.setShard(shard, 3);
+        const auto results = parser.parseAll(directory.path());
+        for (auto iter = results.constBegin(); iter != results.constEnd(); ++iter) {
+            QVERIFY(!shardedResults.contains(iter.key()));
+            shardedResults.insert(iter.key(), iter.value());
+        }
+    }
+    QCOMPARE(shardedResults, allResults);
+}
+
+void TestHeaderDetection::detectBuffers()
+{
+    QFile file(":/testdata/MIT/CharDistribution.cpp");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QByteArray mitContent = file.readAll();
+    const QByteArray spdxContent("// SPDX-License-Identifier: LGPL-2.1-only OR LGPL-3.0-only\n");
+    const QByteArray unlicensedContent("int main() { return 0; }\n");
+
+    const QVector<DirectoryParser::Buffer> buffers {
+        {"src/mit.cpp", mitContent.constData(), mitContent.size()},
+        {"src/spdx.cpp", spdxContent.constData(), spdxContent.size()},
+        {"src/unlicensed.cpp", unlicensedContent.constData(), unlicensedContent.size()},
+        {"src/empty.cpp", nullptr, 0},
+    };
+    DirectoryParser parser;
+    const auto verdicts = parser.detectBuffers(buffers);
+    QCOMPARE(verdicts.size(), 4);
+    QCOMPARE(verdicts.at(0).expression, "MIT");
+    QCOMPARE(verdicts.at(1).expression, "LGPL-2.1-only_OR_LGPL-3.0-only");
+    QCOMPARE(verdicts.at(2).expression, LicenseRegistry::UnknownLicense);
+    QCOMPARE(verdicts.at(3).expression, LicenseRegistry::UnknownLicense);
+
+    // matches with offsets refer to the decoded buffer content
+    const auto matchVerdicts = parser.detectBuffers(buffers.constData(), 1, true);
+    QCOMPARE(matchVerdicts.size(), 1);
+    QVERIFY(!matchVerdicts.first().matches.isEmpty());
+    QCOMPARE(matchVerdicts.first().matches.first().expression, "MIT");
+}
+
+void TestHeaderDetection::concurrentRegistryInitialization()
+{
+    // components are built on first use by whichever thread comes first
+    LicenseRegistry registry;
+    const QString expression("LGPL-2.1-or-later");
+    std::vector<QVector<QRegularExpression>> regexps(4);
+    std::vector<const TokenMatcher *> matchers(4);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&, i]() {
+            regexps[i] = registry.headerTextRegExps(expression);
+            matchers[i] = &registry.tokenMatcher();
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (int i = 1; i < 4; ++i) {
+        QCOMPARE(regexps.at(i), regexps.at(0));
+        QCOMPARE(matchers.at(i), matchers.at(0));
+    }
+    QVERIFY(!regexps.at(0).isEmpty());
+    QVERIFY(registry.licenseFiles().contains("LGPL-2.1-or-later"));
+}
+
+void TestHeaderDetection::precompileHeaderTextRegExps()
+{
+    LicenseRegistry registry;
+    registry.precompileHeaderTextRegExps();
+    for (const auto &expression : registry.expressions()) {
+        // every header text is contained in exactly one capture group, in order of the header texts
+        const auto regexps = registry.headerTextRegExps(expression);
+        int captureCount = 0;
+        for (const auto &regexp : regexps) {
+            QVERIFY2(regexp.isValid(), qPrintable(expression + ": " + regexp.errorString()));
+            captureCount += regexp.captureCount();
+        }
+        QCOMPARE(captureCount, registry.headerTexts(expression).size());
+    }
+    // large expressions are split deterministically
+    const auto regexps = registry.headerTextRegExps("GPL-2.0-or-later");
+    QVERIFY(regexps.size() > 1);
+    QCOMPARE(regexps, LicenseRegistry().headerTextRegExps("GPL-2.0-or-later"));
+    // further calls reuse the compiled expressions
+    registry.precompileHeaderTextRegExps();
+    QCOMPARE(registry.headerTextRegExps("GPL-2.0-or-later"), regexps);
+}
+
+void TestHeaderDetection::benchmarkStartupSmallBatch()
+{
+    // short invocations like pre-commit checks create a parser for a handful of files
+    const QByteArray content("// SPDX-License-Identifier: MIT\n\nint main() { return 0; }\n");
+    const QVector<DirectoryParser::Buffer> buffers {
+        {"src/a.cpp", content.constData(), content.size()},
+        {"src/b.cpp", content.constData(), content.size()},
+        {"src/c.cpp", content.constData(), content.size()},
+    };
+    QVector<DirectoryParser::FileVerdict> verdicts;
+    QBENCHMARK {
+        DirectoryParser parser;
+        verdicts = parser.detectBuffers(buffers);
+    }
+    QCOMPARE(verdicts.size(), 3);
+    QCOMPARE(verdicts.at(0).expression, "MIT");
+}
+
+void TestHeaderDetection::progressReporting()
+{
+    FILE *output = std::tmpfile();
+    QVERIFY(output);
+    ProgressReporter reporter(output, 0);
+    reporter.start(4000);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&reporter]() {
+            for (int file = 0; file < 750; ++file) {
+                reporter.addFile("src/main.cpp", 1024);
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    QCOMPARE(reporter.processedFiles(), 3000);
+    const QString status = reporter.statusText("src/main.cpp");
+    QVERIFY(status.startsWith("3000/4000 files"));
+    QVERIFY(status.contains("MB/s"));
+    QVERIFY(status.contains("ETA"));
+    QVERIFY(status.endsWith("src"));
+    reporter.finish();
+    QVERIFY(std::ftell(output) > 0);
+    std::fclose(output);
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    for (int i = 0; i < 5; ++i) {
+        QFile file(directory.filePath(QString("file%1.cpp").arg(i)));
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write("// SPDX-License-Identifier: MIT\n");
+    }
+    QFile unsupported(directory.filePath("image.png"));
+    QVERIFY(unsupported.open(QIODevice::WriteOnly));
+    unsupported.close();
+
+    DirectoryParser parser;
+    ProgressReporter parserReporter(std::tmpfile());
+    parser.setProgressReporter(&parserReporter);
+    QCOMPARE(parser.parseAll(directory.path()).count(), 5);
+    QCOMPARE(parserReporter.processedFiles(), 5);
+}
+
+void TestHeaderDetection::watchDirectory()
+{
+#ifndef Q_OS_LINUX
+    QSKIP("Watching directories is only supported on Linux");
+#endif
+    auto writeFile = [](const QString &path, const QByteArray &content) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(content);
+    };
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    writeFile(directory.filePath("a.cpp"), "// SPDX-License-Identifier: MIT\n");
+
+    DirectoryParser parser;
+    LicenseWatcher watcher(parser, directory.path());
+    QVERIFY(watcher.start());
+    QCOMPARE(watcher.results().value(directory.filePath("a.cpp")), "MIT");
+    QCOMPARE(watcher.watchedDirectoryCount(), 1);
+    QSignalSpy spy(&watcher, &LicenseWatcher::licenseChanged);
+
+    writeFile(directory.filePath("a.cpp"), "// SPDX-License-Identifier: BSL-1.0\n");
+    QTRY_COMPARE(watcher.results().value(directory.filePath("a.cpp")), "BSL-1.0");
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.at(0).at(1).toString(), "MIT");
+
+    // files of new directories are checked and the directories are watched
+    QVERIFY(QDir(directory.path()).mkdir("sub"));
+    writeFile(directory.filePath("sub/b.cpp"), "// SPDX-License-Identifier: MIT\n");
+    QTRY_COMPARE(watcher.results().value(directory.filePath("sub/b.cpp")), "MIT");
+    QCOMPARE(watcher.watchedDirectoryCount(), 2);
+
+    QVERIFY(QFile::remove(directory.filePath("a.cpp")));
+    QTRY_VERIFY(!watcher.results().contains(directory.filePath("a.cpp")));
+    QCOMPARE(spy.last().at(2).toString(), QString());
+}
+
+void TestHeaderDetection::detectLicenseMatches()
+{
+    QFile file(":/testdata/LGPL-2.0-or-later/AboutPage.qml");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QString fileContents = file.readAll();
+    LicenseRegistry registry;
+
+    const QVector<DirectoryParser::LicenseParser> parserTypes {DirectoryParser::LicenseParser::REGEXP_PARSER,
+                                                                DirectoryParser::LicenseParser::SKIP_PARSER,
+                                                                DirectoryParser::LicenseParser::TOKEN_PARSER,
+                                                                DirectoryParser::LicenseParser::APPROXIMATE_PARSER};
+    for (const auto parserType : parserTypes) {
+        DirectoryParser parser;
+        parser.setLicenseHeaderParser(parserType);
+        const auto matches = parser.detectLicenseMatches(fileContents);
+        QVERIFY(!matches.isEmpty());
+        bool found = false;
+        for (const auto &match : matches) {
+            const QVector<QString> headers = registry.headerTexts(match.expression);
+            QVERIFY(match.templateIndex >= 0 && match.templateIndex < headers.size());
+            QVERIFY(match.start >= 0 && match.length > 0 && match.start + match.length <= fileContents.size());
+            QCOMPARE(match.distance, 0);
+            // matched text starts with the first word of the matched header text
+            const QString firstWord = headers.at(match.templateIndex).simplified().section(' ', 0, 0);
+            QVERIFY(fileContents.mid(match.start).startsWith(firstWord));
+            found |= match.expression == "LGPL-2.0-or-later";
+        }
+        QVERIFY(found);
+    }
+}
+
+void TestHeaderDetection::detectApproximateLicenses()
+{
+    QFile file(":/testdata/LGPL-2.0-or-later/AboutPage.qml");
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QString fileContents = file.readAll();
+    // typo and changed address
+    QVERIFY(fileContents.contains("redistribute"));
+    fileContents.replace("redistribute", "redistribtue");
+    QVERIFY(fileContents.contains("51 Franklin Street"));
+    fileContents.replace("51 Franklin Street", "59 Franklin Street");
+
+    DirectoryParser parser;
+    QVERIFY(parser.detectLicenses(fileContents).isEmpty());
+
+    const auto matches = parser.detectLicensesApproximate(fileContents);
+    QCOMPARE(matches.count(), 1);
+    QCOMPARE(matches.first().expression, "LGPL-2.0-or-later");
+    QCOMPARE(matches.first().distance, 2);
+
+    parser.setLicenseHeaderParser(DirectoryParser::LicenseParser::APPROXIMATE_PARSER);
+    QCOMPARE(parser.detectLicenses(fileContents), QVector<LicenseRegistry::SpdxExpression> {"LGPL-2.0-or-later"});
+
+    // a different version is a different license, also for short headers
+    const QString otherVersion("# Licensed under the GNU GPL v2.0 terms\n");
+    QVERIFY(!parser.detectLicenses(otherVersion).contains("GPL-3.0-only"));
+    QVERIFY(!parser.detectLicenses("# License: GNU General Public License V3\n").contains("GPL-2.0-only"));
+}
+
 QTEST_GUILESS_MAIN(TestHeaderDetection);
@@ -45,9 +45,24 @@ private Q_SLOTS:
 
     // detection logic tests
     void detectSpdxExpressions();
+    void spdxTagScanner();
+    void approximateMatcher();
+    void tokenMatcher();
+    void similarityIndex();
+    void headerDeduplication();
+    void shardedParsing();
+    void detectBuffers();
+    void concurrentRegistryInitialization();
+    void precompileHeaderTextRegExps();
+    void benchmarkStartupSmallBatch();
+    void progressReporting();
+    void watchDirectory();
+    void detectLicenseMatches();
+    void detectApproximateLicenses();
 
 private:
     void detectForIdentifierRegExpParser(const QString &spdxMarker);
     void detectForIdentifierSkipParser(const QString &spdxMarker);
+    void detectForIdentifierTokenParser(const QString &spdxMarker);
 };
 #endif
@@ -11,9 +11,16 @@
 #include <QVector>
 #include <QDebug>
 #include <QDir>
+#include <QTemporaryDir>
 
 static const QString licensesRootPath(":/licenses_templates/%1");
 
+void TestLicenseConvert::initTestCase()
+{
+    // license templates are read before any LicenseRegistry registers the resources of the library
+    Q_INIT_RESOURCE(licenses);
+}
+
 void TestLicenseConvert::greedyLicenseTextConversion()
 {
     // use non-correctly converted license as test data
@@ -98,6 +105,21 @@ void TestLicenseConvert::pruneLicenseList()
         QCOMPARE(prunedLicenses.length(), 1);
         QCOMPARE(prunedLicenses.first(), "LGPL-2.1-only_WITH_Qt-Commercial-exception-1.0");
     }
+
+    // prune nested OR combinations and equivalent expressions
+    {
+        QVector<LicenseRegistry::SpdxExpression> licenses{ "LGPL-2.1-only_OR_LGPL-3.0-only_OR_LicenseRef-KDE-Accepted-LGPL", "LGPL-3.0-only_OR_LGPL-2.1-only", "LGPL-2.1-only_OR_LGPL-3.0-only"};
+        auto prunedLicenses = parser.pruneLicenseList(licenses);
+        QCOMPARE(prunedLicenses.length(), 1);
+        QCOMPARE(prunedLicenses.first(), "LGPL-2.1-only_OR_LGPL-3.0-only_OR_LicenseRef-KDE-Accepted-LGPL");
+    }
+
+    // different licenses are kept
+    {
+        QVector<LicenseRegistry::SpdxExpression> licenses{ "MIT", "LGPL-2.1-only_OR_LGPL-3.0-only"};
+        auto prunedLicenses = parser.pruneLicenseList(licenses);
+        QCOMPARE(prunedLicenses.length(), 2);
+    }
 }
 
 void TestLicenseConvert::exampleFileConversion()
@@ -139,4 +161,31 @@ void TestLicenseConvert::exampleFileConversion()
     }
 }
 
+void TestLicenseConvert::convertDirectory()
+{
+    const QString baseFileName {":/testdata_conversionexamples/fake_notifications_server.h"};
+    QFile fileOrig(baseFileName + ".origfile");
+    QVERIFY(fileOrig.open(QIODevice::ReadOnly));
+    QFile fileSpdx(baseFileName + ".spdx");
+    QVERIFY(fileSpdx.open(QIODevice::ReadOnly));
+    const QByteArray fileContentSpdx = fileSpdx.readAll();
+
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString filePath = directory.filePath("fake_notifications_server.h");
+    {
+        QFile file(filePath);
+        QVERIFY(file.open(QIODevice::WriteOnly));
+        file.write(fileOrig.readAll());
+    }
+
+    // convert mode replaces the license text at the offsets found during detection
+    DirectoryParser parser;
+    const auto results = parser.parseAll(directory.path(), true);
+    QCOMPARE(results.value(filePath), "LGPL-2.0-only");
+    QFile file(filePath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(file.readAll(), fileContentSpdx);
+}
+
 QTEST_GUILESS_MAIN(TestLicenseConvert);
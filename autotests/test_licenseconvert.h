@@ -17,6 +17,8 @@ public:
     TestLicenseConvert() = default;
 
 private Q_SLOTS:
+    void initTestCase();
+
     /**
      * @brief Test shall ensure correct expression ordering in regex for single license
      *
@@ -37,5 +39,6 @@ private Q_SLOTS:
      * Conformance test with original and target file format
      */
     void exampleFileConversion();
+    void convertDirectory();
 };
 #endif
@@ -0,0 +1,197 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "test_reportwriter.h"
+#include "../reportmerger.h"
+#include "../reportwriter.h"
+#include "../spdxdocumentwriter.h"
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTest>
+
+namespace
+{
+void addExampleFiles(ReportWriter &writer)
+{
+    writer.addFile("src/a.cpp", "LGPL-2.0-or-later");
+    writer.addFile("src/b \"quoted\",name.cpp", "LGPL-2.0-or-later", 2);
+    writer.addFile("src/c.cpp", LicenseRegistry::UnknownLicense, 0, SimilarityIndex::Match {"GPL-2.0-or-later", 0.75});
+}
+}
+
+void TestReportWriter::jsonReport()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    ReportWriter writer(ReportWriter::Format::JSON, &buffer);
+    addExampleFiles(writer);
+    writer.finish(42);
+
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(buffer.data(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    const QJsonArray files = document.object().value("files").toArray();
+    QCOMPARE(files.count(), 3);
+    QCOMPARE(files.at(1).toObject().value("path").toString(), "src/b \"quoted\",name.cpp");
+    QCOMPARE(files.at(1).toObject().value("editDistance").toInt(), 2);
+    QVERIFY(!files.at(0).toObject().contains("editDistance"));
+    QCOMPARE(files.at(2).toObject().value("mostSimilar").toString(), "GPL-2.0-or-later");
+
+    const QJsonObject summary = document.object().value("summary").toObject();
+    QCOMPARE(summary.value("files").toInt(), 3);
+    QCOMPARE(summary.value("undetected").toInt(), 1);
+    QCOMPARE(summary.value("elapsedMs").toInt(), 42);
+    QCOMPARE(summary.value("expressions").toObject().value("LGPL-2.0-or-later").toInt(), 2);
+}
+
+void TestReportWriter::ndjsonReport()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    ReportWriter writer(ReportWriter::Format::NDJSON, &buffer);
+    addExampleFiles(writer);
+    writer.finish(42);
+
+    const QList<QByteArray> lines = buffer.data().trimmed().split('\n');
+    QCOMPARE(lines.count(), 4);
+    for (const auto &line : lines) {
+        QJsonParseError error;
+        QJsonDocument::fromJson(line, &error);
+        QCOMPARE(error.error, QJsonParseError::NoError);
+    }
+    QCOMPARE(QJsonDocument::fromJson(lines.at(0)).object().value("expression").toString(), "LGPL-2.0-or-later");
+    QCOMPARE(QJsonDocument::fromJson(lines.at(3)).object().value("summary").toObject().value("undetected").toInt(), 1);
+}
+
+void TestReportWriter::csvReport()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    ReportWriter writer(ReportWriter::Format::CSV, &buffer);
+    addExampleFiles(writer);
+    QTest::ignoreMessage(QtInfoMsg, "Report summary: 3 files, 1 undetected, 42 ms; LGPL-2.0-or-later: 2, UNKNOWN-LICENSE: 1");
+    writer.finish(42);
+
+    const QList<QByteArray> lines = buffer.data().split('\n');
+    QCOMPARE(lines.at(0), QByteArray("path,expression,edit_distance,most_similar,similarity"));
+    QCOMPARE(lines.at(1), QByteArray("src/a.cpp,LGPL-2.0-or-later,,,"));
+    QCOMPARE(lines.at(2), QByteArray("\"src/b \"\"quoted\"\",name.cpp\",LGPL-2.0-or-later,2,,"));
+    QCOMPARE(lines.at(3), QByteArray("src/c.cpp,UNKNOWN-LICENSE,,GPL-2.0-or-later,0.750"));
+    // every line is a data row
+    QCOMPARE(lines.size(), 5);
+    QCOMPARE(lines.at(4), QByteArray());
+}
+
+void TestReportWriter::mergePartialReports()
+{
+    QBuffer firstShard;
+    QVERIFY(firstShard.open(QIODevice::ReadWrite));
+    ReportWriter firstWriter(ReportWriter::Format::NDJSON, &firstShard);
+    firstWriter.addFile("src/c.cpp", LicenseRegistry::UnknownLicense, 0, SimilarityIndex::Match {"GPL-2.0-or-later", 0.75});
+    firstWriter.addFile("src/a.cpp", "LGPL-2.0-or-later");
+    firstWriter.finish(40);
+
+    QBuffer secondShard;
+    QVERIFY(secondShard.open(QIODevice::ReadWrite));
+    ReportWriter secondWriter(ReportWriter::Format::NDJSON, &secondShard);
+    secondWriter.addFile("src/b \"quoted\",name.cpp", "LGPL-2.0-or-later", 2);
+    secondWriter.finish(42);
+
+    ReportMerger merger;
+    firstShard.seek(0);
+    secondShard.seek(0);
+    QVERIFY(merger.addPartialReport(&firstShard));
+    QVERIFY(merger.addPartialReport(&secondShard));
+    QCOMPARE(merger.fileCount(), 3);
+
+    QBuffer merged;
+    QVERIFY(merged.open(QIODevice::WriteOnly));
+    ReportWriter mergedWriter(ReportWriter::Format::NDJSON, &merged);
+    merger.write(mergedWriter);
+
+    QBuffer expected;
+    QVERIFY(expected.open(QIODevice::WriteOnly));
+    ReportWriter expectedWriter(ReportWriter::Format::NDJSON, &expected);
+    addExampleFiles(expectedWriter);
+    expectedWriter.finish(42);
+    QCOMPARE(merged.data(), expected.data());
+
+    // report of an interrupted shard has no summary
+    QBuffer truncated;
+    truncated.setData(expected.data().left(expected.data().indexOf("{\"summary\"")));
+    QVERIFY(truncated.open(QIODevice::ReadOnly));
+    QVERIFY(!ReportMerger().addPartialReport(&truncated));
+}
+
+void TestReportWriter::spdxLicenseInfo()
+{
+    QCOMPARE(SpdxDocumentWriter::licenseInfoInFile("GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL"),
+             QStringList({"GPL-2.0-only", "GPL-3.0-only", "LicenseRef-KDE-Accepted-GPL"}));
+    QCOMPARE(SpdxDocumentWriter::licenseInfoInFile("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LGPL-3.0-only_WITH_Qt-LGPL-exception-1.1_OR_LicenseRef-Qt-Commercial"),
+             QStringList({"LGPL-2.1-only", "LGPL-3.0-only", "LicenseRef-Qt-Commercial"}));
+    QCOMPARE(SpdxDocumentWriter::licenseInfoInFile(LicenseRegistry::UnknownLicense), QStringList({"NOASSERTION"}));
+    QCOMPARE(SpdxDocumentWriter::licenseInfoInFile(LicenseRegistry::MissingLicenseForGeneratedFile), QStringList({"NONE"}));
+}
+
+void TestReportWriter::spdxTagValueDocument()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    SpdxDocumentWriter writer(SpdxDocumentWriter::Format::TAG_VALUE, &buffer, "example");
+    writer.addFile("src/a.cpp", "MIT_OR_BSL-1.0", QByteArray::fromHex("da39a3ee5e6b4b0d3255bfef95601890afd80709"), {"2026 Jane Doe <jane@example.org>"});
+    writer.addFile("src/b.cpp", LicenseRegistry::MissingLicense, QByteArray::fromHex("da39a3ee5e6b4b0d3255bfef95601890afd80709"), {});
+    writer.addFile("src/c.cpp",
+                   "GPL-2.0-only_OR_GPL-3.0-only_OR_LicenseRef-KDE-Accepted-GPL",
+                   QByteArray::fromHex("da39a3ee5e6b4b0d3255bfef95601890afd80709"),
+                   {"2026 Jane Doe </text>"});
+    writer.finish();
+
+    const QByteArray document = buffer.data();
+    QVERIFY(document.startsWith("SPDXVersion: SPDX-2.3\n"));
+    QVERIFY(document.contains("DocumentNamespace: https://spdx.org/spdxdocs/example-"));
+    QVERIFY(document.contains("FileName: ./src/a.cpp\nSPDXID: SPDXRef-File-1\nFileChecksum: SHA1: da39a3ee5e6b4b0d3255bfef95601890afd80709\n"));
+    QVERIFY(document.contains("LicenseInfoInFile: MIT\nLicenseInfoInFile: BSL-1.0\n"));
+    QVERIFY(document.contains("FileCopyrightText: <text>2026 Jane Doe <jane@example.org></text>\n"));
+    QVERIFY(document.contains("LicenseInfoInFile: NONE\nFileCopyrightText: NONE\n"));
+    QVERIFY(document.contains("Relationship: SPDXRef-DOCUMENT DESCRIBES SPDXRef-File-3\n"));
+    QVERIFY(document.contains("FileCopyrightText: <text>2026 Jane Doe &lt;/text&gt;</text>\n"));
+    // license references must be defined within the document
+    QCOMPARE(document.count("LicenseID: LicenseRef-KDE-Accepted-GPL\nExtractedText: <text>"), 1);
+    QVERIFY(document.contains("LicenseName: KDE-Accepted-GPL\n"));
+}
+
+void TestReportWriter::spdxJsonDocument()
+{
+    QBuffer buffer;
+    QVERIFY(buffer.open(QIODevice::WriteOnly));
+    SpdxDocumentWriter writer(SpdxDocumentWriter::Format::JSON, &buffer, "example");
+    writer.addFile("src/a.cpp", "MIT_OR_BSL-1.0", QByteArray::fromHex("da39a3ee5e6b4b0d3255bfef95601890afd80709"), {"2026 Jane Doe", "2025 John Doe"});
+    writer.addFile("src/b.cpp", LicenseRegistry::UnknownLicense, QByteArray::fromHex("da39a3ee5e6b4b0d3255bfef95601890afd80709"), {});
+    writer.addFile("src/c.cpp", "LGPL-2.1-only_OR_LicenseRef-KDE-Accepted-LGPL", QByteArray::fromHex("da39a3ee5e6b4b0d3255bfef95601890afd80709"), {});
+    writer.finish();
+
+    QJsonParseError error;
+    const QJsonObject document = QJsonDocument::fromJson(buffer.data(), &error).object();
+    QCOMPARE(error.error, QJsonParseError::NoError);
+    QCOMPARE(document.value("spdxVersion").toString(), "SPDX-2.3");
+    const QJsonArray files = document.value("files").toArray();
+    QCOMPARE(files.count(), 3);
+    const QJsonObject first = files.at(0).toObject();
+    QCOMPARE(first.value("fileName").toString(), "./src/a.cpp");
+    QCOMPARE(first.value("licenseInfoInFiles").toArray().count(), 2);
+    QCOMPARE(first.value("copyrightText").toString(), "2026 Jane Doe\n2025 John Doe");
+    QCOMPARE(first.value("checksums").toArray().at(0).toObject().value("checksumValue").toString(), "da39a3ee5e6b4b0d3255bfef95601890afd80709");
+    QCOMPARE(files.at(1).toObject().value("licenseInfoInFiles").toArray().at(0).toString(), "NOASSERTION");
+    QCOMPARE(document.value("relationships").toArray().count(), 3);
+    const QJsonArray licenseInfos = document.value("hasExtractedLicensingInfos").toArray();
+    QCOMPARE(licenseInfos.count(), 1);
+    QCOMPARE(licenseInfos.at(0).toObject().value("licenseId").toString(), "LicenseRef-KDE-Accepted-LGPL");
+    QVERIFY(!licenseInfos.at(0).toObject().value("extractedText").toString().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestReportWriter);
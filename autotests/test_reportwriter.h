@@ -0,0 +1,25 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef TEST_REPORTWRITER_H
+#define TEST_REPORTWRITER_H
+
+#include <QObject>
+
+class TestReportWriter : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void jsonReport();
+    void ndjsonReport();
+    void csvReport();
+    void mergePartialReports();
+    void spdxLicenseInfo();
+    void spdxTagValueDocument();
+    void spdxJsonDocument();
+};
+#endif
@@ -6,6 +6,7 @@
 
 #include "test_skipparser.h"
 #include "../skipparser.h"
+#include "../skipcharpruner.h"
 #include "../licenseregistry.h"
 #include <QTest>
 #include <QVector>
@@ -71,6 +72,14 @@ void TestSkipParser::basicStringMatcher()
         QCOMPARE(match->first, 3);
         QCOMPARE(match->second, 8);
     }
+    { // leading skips and multiple skip runs inside of match
+        QString pattern{"bcd"};
+        QString text{"  ab c  d"};
+        auto match = parser.findMatch(text, pattern);
+        QVERIFY(match);
+        QCOMPARE(match->first, 3);
+        QCOMPARE(match->second, 8);
+    }
     { // not matching and skip at right side
         QString pattern{"aa a"};
         QString text{"abca  a"};
@@ -116,6 +125,61 @@ void TestSkipParser::basicPatternSetMatcher()
         QCOMPARE(match->first, 3);
         QCOMPARE(match->second, 5);
     }
+    { // index of matching pattern
+        QVector<QString> patterns = {{"xyz"}, {"aa a"}, {"aaa"}};
+        QString text{"abcaaabc"};
+        int patternIndex = -1;
+        auto match = parser.findMatch(text, patterns, &patternIndex);
+        QVERIFY(match);
+        QCOMPARE(patternIndex, 1);
+    }
+}
+
+void TestSkipParser::prunerImplementations()
+{
+    const SkipCharPruner scalarPruner(SkipCharPruner::Implementation::Scalar);
+    QCOMPARE(scalarPruner.implementation(), SkipCharPruner::Implementation::Scalar);
+
+    // texts cover block sizes of all implementations, blocks with only skip chars, without skip chars
+    // and non-Latin1 characters whose low byte equals a skip char
+    QVector<QString> texts {
+        QString(),
+        QStringLiteral("a"),
+        QStringLiteral(" a-b"),
+        QString(40, QLatin1Char(' ')) + QStringLiteral("abc"),
+        QString(70, QLatin1Char('x')) + QStringLiteral(" \n\t/-*#") + QString(33, QLatin1Char('y')),
+        QStringLiteral(" * This library is free software; you can redistribute it and/or\n"
+                       " * modify it under the terms of the GNU Library General Public\n"
+                       " * License as published by the Free Software Foundation; either\n"),
+        QString(QChar(0x2120)) + QChar(0x012A) + QChar(0x0A20) + QStringLiteral("  ##  ") + QChar(0x202F) + QString(20, QLatin1Char('-')),
+    };
+    for (int i = 0; i < 200; ++i) {
+        QString text;
+        for (int j = 0; j < i; ++j) {
+            text.append((i * 7 + j * 13) % 5 == 0 ? QLatin1Char('*') : QLatin1Char('a' + (j % 26)));
+        }
+        texts.append(text);
+    }
+
+    for (auto implementation : {SkipCharPruner::Implementation::SSE2, SkipCharPruner::Implementation::AVX2}) {
+        if (!SkipCharPruner::isSupported(implementation)) {
+            qDebug() << "Skipping unsupported pruner implementation" << static_cast<int>(implementation);
+            continue;
+        }
+        const SkipCharPruner pruner(implementation);
+        QCOMPARE(pruner.implementation(), implementation);
+        for (const auto &text : texts) {
+            QString expected(text.size(), Qt::Uninitialized);
+            SkipCharPruner::SkipRuns expectedRuns;
+            expected.resize(scalarPruner.prune(text.constData(), text.size(), expected.data(), expectedRuns));
+
+            QString pruned(text.size(), Qt::Uninitialized);
+            SkipCharPruner::SkipRuns runs;
+            pruned.resize(pruner.prune(text.constData(), text.size(), pruned.data(), runs));
+            QCOMPARE(pruned, expected);
+            QVERIFY(runs == expectedRuns);
+        }
+    }
 }
 
 QTEST_GUILESS_MAIN(TestSkipParser);
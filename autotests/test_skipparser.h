@@ -17,5 +17,8 @@ private Q_SLOTS:
     // simple parser tests
     void basicStringMatcher();
     void basicPatternSetMatcher();
+
+    // vectorized skip char pruning
+    void prunerImplementations();
 };
 #endif
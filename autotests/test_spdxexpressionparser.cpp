@@ -0,0 +1,79 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "test_spdxexpressionparser.h"
+#include "../spdxexpressionparser.h"
+#include <QTest>
+
+void TestSpdxExpressionParser::parseExpressions()
+{
+    SpdxExpressionParser parser;
+
+    const auto single = parser.parse("GPL-2.0-or-later");
+    QVERIFY(single);
+    QCOMPARE(single->nodes.size(), 1);
+    QCOMPARE(single->nodes.at(single->root()).type, SpdxExpressionParser::NodeType::LICENSE);
+    QCOMPARE(parser.identifier(single->nodes.at(single->root()).identifier), "GPL-2.0-or-later");
+
+    // WITH binds stronger than AND, AND stronger than OR
+    const auto registryExpression = parser.parse("LGPL-2.1-only_WITH_Qt-LGPL-exception-1.1_OR_LGPL-3.0-only_AND_MIT");
+    QVERIFY(registryExpression);
+    QCOMPARE(registryExpression->nodes.at(registryExpression->root()).type, SpdxExpressionParser::NodeType::OR);
+    QCOMPARE(parser.toString(*registryExpression), "LGPL-2.1-only WITH Qt-LGPL-exception-1.1 OR LGPL-3.0-only AND MIT");
+    QCOMPARE(parser.identifiers(*registryExpression), QStringList({"LGPL-2.1-only", "Qt-LGPL-exception-1.1", "LGPL-3.0-only", "MIT"}));
+
+    const auto statement = parser.parse("(MIT OR BSL-1.0) AND GPL-2.0-only");
+    QVERIFY(statement);
+    QCOMPARE(parser.toString(*statement, QLatin1Char('_')), "GPL-2.0-only_AND_(BSL-1.0_OR_MIT)");
+
+    // lower case operators are valid as well
+    QCOMPARE(parser.toString(*parser.parse("MIT or BSL-1.0")), "BSL-1.0 OR MIT");
+
+    // identifiers are interned
+    QCOMPARE(single->nodes.at(single->root()).identifier, parser.parse("GPL-2.0-or-later_OR_MIT")->nodes.at(0).identifier);
+}
+
+void TestSpdxExpressionParser::rejectInvalidExpressions()
+{
+    SpdxExpressionParser parser;
+    QVERIFY(!parser.parse(""));
+    QVERIFY(!parser.parse("MIT OR"));
+    QVERIFY(!parser.parse("OR MIT"));
+    QVERIFY(!parser.parse("(MIT OR BSL-1.0"));
+    QVERIFY(!parser.parse("MIT BSL-1.0"));
+    QVERIFY(!parser.parse("(MIT OR BSL-1.0) WITH Qt-LGPL-exception-1.1"));
+    QVERIFY(!parser.parse("MIT Or BSL-1.0"));
+}
+
+void TestSpdxExpressionParser::canonicalForm()
+{
+    SpdxExpressionParser parser;
+    const auto first = parser.parse("B-1.0 OR (A-1.0 OR B-1.0)");
+    const auto second = parser.parse("A-1.0_OR_B-1.0");
+    QVERIFY(first && second);
+    QVERIFY(SpdxExpressionParser::isEqual(*first, first->root(), *second, second->root()));
+    QCOMPARE(parser.toString(*first), "A-1.0 OR B-1.0");
+
+    const auto third = parser.parse("A-1.0 AND B-1.0");
+    QVERIFY(!SpdxExpressionParser::isEqual(*first, first->root(), *third, third->root()));
+}
+
+void TestSpdxExpressionParser::containsTerm()
+{
+    SpdxExpressionParser parser;
+    const auto outer = parser.parse("A-1.0 WITH E-1.0 OR B-1.0 OR C-1.0");
+    QVERIFY(outer);
+    QVERIFY(SpdxExpressionParser::containsTerm(*outer, *parser.parse("A-1.0")));
+    QVERIFY(SpdxExpressionParser::containsTerm(*outer, *parser.parse("A-1.0 WITH E-1.0")));
+    QVERIFY(SpdxExpressionParser::containsTerm(*outer, *parser.parse("C-1.0 OR B-1.0")));
+    QVERIFY(SpdxExpressionParser::containsTerm(*outer, *outer));
+    QVERIFY(!SpdxExpressionParser::containsTerm(*outer, *parser.parse("D-1.0")));
+    QVERIFY(!SpdxExpressionParser::containsTerm(*outer, *parser.parse("B-1.0 AND C-1.0")));
+    QVERIFY(!SpdxExpressionParser::containsTerm(*outer, *parser.parse("A-1.0 WITH F-1.0")));
+    QVERIFY(!SpdxExpressionParser::containsTerm(*parser.parse("A-1.0"), *outer));
+}
+
+QTEST_GUILESS_MAIN(TestSpdxExpressionParser);
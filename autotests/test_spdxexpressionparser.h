@@ -0,0 +1,22 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef TEST_SPDXEXPRESSIONPARSER_H
+#define TEST_SPDXEXPRESSIONPARSER_H
+
+#include <QObject>
+
+class TestSpdxExpressionParser : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void parseExpressions();
+    void rejectInvalidExpressions();
+    void canonicalForm();
+    void containsTerm();
+};
+#endif
@@ -0,0 +1,208 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "test_tararchivereader.h"
+#include "../directoryparser.h"
+#include "../tararchivereader.h"
+#include <QBuffer>
+#include <QTemporaryDir>
+#include <QTest>
+#include <cstring>
+#include <zlib.h>
+
+namespace
+{
+QByteArray tarEntry(const QByteArray &name,
+                    const QByteArray &content,
+                    char type = '0',
+                    const QByteArray &prefix = QByteArray(),
+                    const QByteArray &magic = QByteArray("ustar\0" "00", 8))
+{
+    QByteArray header(512, '\0');
+    std::memcpy(header.data(), name.constData(), std::min<int>(name.size(), 100));
+    std::memcpy(header.data() + 100, "0000644", 7);
+    std::memcpy(header.data() + 124, QByteArray::number(content.size(), 8).rightJustified(11, '0').constData(), 11);
+    header[156] = type;
+    std::memcpy(header.data() + 257, magic.constData(), std::min<int>(magic.size(), 8));
+    std::memcpy(header.data() + 345, prefix.constData(), std::min<int>(prefix.size(), 155));
+    std::memset(header.data() + 148, ' ', 8);
+    int checksum = 0;
+    for (const char byte : header) {
+        checksum += static_cast<uchar>(byte);
+    }
+    std::memcpy(header.data() + 148, QByteArray::number(checksum, 8).rightJustified(6, '0').constData(), 6);
+    header[154] = '\0';
+
+    QByteArray data = content;
+    data.append(QByteArray((512 - content.size() % 512) % 512, '\0'));
+    return header + data;
+}
+
+QByteArray paxRecord(const QByteArray &key, const QByteArray &value)
+{
+    // the length includes the length field itself
+    const QByteArray record = ' ' + key + '=' + value + '\n';
+    int length = record.size() + 1;
+    while (QByteArray::number(length).size() + record.size() != length) {
+        ++length;
+    }
+    return QByteArray::number(length) + record;
+}
+
+QByteArray gzip(const QByteArray &data)
+{
+    z_stream stream {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    QByteArray output(static_cast<int>(deflateBound(&stream, data.size())), '\0');
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.constData()));
+    stream.avail_in = data.size();
+    stream.next_out = reinterpret_cast<Bytef *>(output.data());
+    stream.avail_out = output.size();
+    deflate(&stream, Z_FINISH);
+    output.resize(static_cast<int>(stream.total_out));
+    deflateEnd(&stream);
+    return output;
+}
+
+QByteArray testArchive()
+{
+    const QByteArray longName = QByteArray("src/") + QByteArray(120, 'a') + ".cpp";
+    return tarEntry("./src/", QByteArray(), '5') + tarEntry("./src/main.cpp", "// SPDX-License-Identifier: MIT\n")
+        + tarEntry("././@LongLink", longName + '\0', 'L') + tarEntry(longName.left(100), "long\n")
+        + tarEntry("PaxHeaders/pax.cpp", paxRecord("path", "src/pax/pax.cpp"), 'x') + tarEntry("pax.cpp", "pax\n")
+        + tarEntry("prefixed.h", "prefixed\n", '0', "include/project")
+        // old GNU headers store access and change times where POSIX headers have the prefix
+        + tarEntry("gnu.cpp", "gnu\n", '0', "14712345670", QByteArray("ustar  \0", 8)) + tarEntry("README.md", QByteArray(2000, 'r'))
+        + QByteArray(1024, '\0');
+}
+}
+
+void TestTarArchiveReader::readEntries()
+{
+    QByteArray archive = testArchive();
+    QBuffer device(&archive);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    TarArchiveReader reader(&device);
+    TarArchiveReader::Entry entry;
+    QByteArray content;
+
+    QVERIFY(reader.next(&entry));
+    QCOMPARE(entry.path, "src/main.cpp");
+    QVERIFY(reader.readContent(&content));
+    QCOMPARE(content, QByteArray("// SPDX-License-Identifier: MIT\n"));
+
+    // content of entries that are not read is skipped
+    QVERIFY(reader.next(&entry));
+    QCOMPARE(entry.path, QString("src/" + QString(120, 'a') + ".cpp"));
+    QCOMPARE(entry.size, qint64(5));
+
+    QVERIFY(reader.next(&entry));
+    QCOMPARE(entry.path, "src/pax/pax.cpp");
+    QVERIFY(reader.readContent(&content));
+    QCOMPARE(content, QByteArray("pax\n"));
+
+    QVERIFY(reader.next(&entry));
+    QCOMPARE(entry.path, "include/project/prefixed.h");
+    QVERIFY(reader.next(&entry));
+    QCOMPARE(entry.path, "gnu.cpp");
+    QVERIFY(reader.next(&entry));
+    QCOMPARE(entry.path, "README.md");
+    QCOMPARE(entry.size, qint64(2000));
+
+    QVERIFY(!reader.next(&entry));
+    QVERIFY(!reader.hasError());
+}
+
+void TestTarArchiveReader::readCompressedEntries()
+{
+    // concatenated gzip members are one stream
+    const QByteArray archive = testArchive();
+    QByteArray compressed = gzip(archive.left(2048)) + gzip(archive.mid(2048));
+    QBuffer device(&compressed);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    TarArchiveReader reader(&device);
+    TarArchiveReader::Entry entry;
+    QByteArray content;
+    QStringList paths;
+    while (reader.next(&entry)) {
+        paths.append(entry.path);
+        if (entry.path == "README.md") {
+            QVERIFY(reader.readContent(&content));
+            QCOMPARE(content, QByteArray(2000, 'r'));
+        }
+    }
+    QVERIFY(!reader.hasError());
+    QCOMPARE(paths, QStringList({"src/main.cpp", "src/" + QString(120, 'a') + ".cpp", "src/pax/pax.cpp", "include/project/prefixed.h", "gnu.cpp", "README.md"}));
+}
+
+void TestTarArchiveReader::rejectTruncatedArchive()
+{
+    const QByteArray archive = testArchive();
+    for (const QByteArray &truncated : {archive.left(512 + 256), gzip(archive).left(100)}) {
+        QByteArray data = truncated;
+        QBuffer device(&data);
+        QVERIFY(device.open(QIODevice::ReadOnly));
+        TarArchiveReader reader(&device);
+        TarArchiveReader::Entry entry;
+        while (reader.next(&entry)) { }
+        QVERIFY(reader.hasError());
+    }
+
+    QByteArray corrupt = archive;
+    corrupt[512] = 'X';
+    QBuffer device(&corrupt);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+    TarArchiveReader reader(&device);
+    TarArchiveReader::Entry entry;
+    QVERIFY(!reader.next(&entry));
+    QVERIFY(reader.hasError());
+}
+
+void TestTarArchiveReader::parseArchive()
+{
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString archivePath = directory.filePath("project-1.0.tar.gz");
+    QFile output(archivePath);
+    QVERIFY(output.open(QIODevice::WriteOnly));
+    output.write(gzip(tarEntry("project-1.0/src/main.cpp", "// SPDX-License-Identifier: MIT\n") + tarEntry("project-1.0/src/other.cpp", "int main() { return 0; }\n")
+                      + tarEntry("project-1.0/README.md", "// SPDX-License-Identifier: MIT\n") + QByteArray(1024, '\0')));
+    output.close();
+    QVERIFY(TarArchiveReader::isArchiveFileName(archivePath));
+
+    DirectoryParser parser;
+    QStringList handledFiles;
+    parser.setFileResultHandler(
+        [&handledFiles](const DirectoryParser::FileResult &result) {
+            handledFiles.append(result.filePath);
+            QCOMPARE(result.sha1.size(), 20);
+        },
+        true);
+    const auto results = parser.parseArchive(archivePath);
+    QCOMPARE(results.size(), 2);
+    QCOMPARE(results.value(archivePath + "!/project-1.0/src/main.cpp"), "MIT");
+    QCOMPARE(results.value(archivePath + "!/project-1.0/src/other.cpp"), LicenseRegistry::UnknownLicense);
+    QCOMPARE(handledFiles.size(), 2);
+    QVERIFY(parser.errorString().isEmpty());
+
+    const auto filteredResults = parser.parseArchive(archivePath, "other");
+    QCOMPARE(filteredResults.keys(), QStringList({archivePath + "!/project-1.0/src/main.cpp"}));
+
+    // incomplete archives are reported as errors
+    const QString truncatedPath = directory.filePath("truncated.tar");
+    QFile truncated(truncatedPath);
+    QVERIFY(truncated.open(QIODevice::WriteOnly));
+    truncated.write(tarEntry("src/main.cpp", "// SPDX-License-Identifier: MIT\n").left(512 + 10));
+    truncated.close();
+    QVERIFY(parser.parseArchive(truncatedPath).isEmpty());
+    QVERIFY(!parser.errorString().isEmpty());
+    parser.parseArchive(directory.filePath("missing.tar"));
+    QVERIFY(!parser.errorString().isEmpty());
+    parser.parseArchive(archivePath);
+    QVERIFY(parser.errorString().isEmpty());
+}
+
+QTEST_GUILESS_MAIN(TestTarArchiveReader);
@@ -0,0 +1,295 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "copyrightscanner.h"
+#include <array>
+
+namespace
+{
+constexpr char16_t sCopyrightSign = 0x00A9;
+
+class Input
+{
+public:
+    explicit Input(QStringView text)
+        : mData(text.utf16())
+        , mSize(static_cast<int>(text.size()))
+    {
+    }
+
+    int size() const
+    {
+        return mSize;
+    }
+
+    //! @return character at @p position or 0 if the position is out of range
+    char16_t at(int position) const
+    {
+        return position >= 0 && position < mSize ? mData[position] : 0;
+    }
+
+    bool startsWith(int position, const char *literal) const
+    {
+        for (; *literal != '\0'; ++literal, ++position) {
+            if (at(position) != static_cast<char16_t>(*literal)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    const char16_t *mData;
+    int mSize;
+};
+
+bool isSpace(char16_t character)
+{
+    return character == ' ' || character == '\t' || character == '\n' || character == '\v' || character == '\f' || character == '\r';
+}
+
+bool isDigit(char16_t character)
+{
+    return character >= '0' && character <= '9';
+}
+
+bool isSeparator(char16_t character)
+{
+    return character == ',' || character == ' ';
+}
+
+bool isNameCharacter(char16_t character)
+{
+    return (character >= 'a' && character <= 'z') || (character >= 'A' && character <= 'Z') || (character >= 0x00C0 && character <= 0x017F) || character == '-'
+        || character == '.';
+}
+
+bool isLetterC(char16_t character)
+{
+    return character == 'c' || character == 'C';
+}
+
+//! "[cC]opyright"
+bool isCopyrightWord(const Input &input, int position)
+{
+    return isLetterC(input.at(position)) && input.startsWith(position + 1, "opyright");
+}
+
+//! "(?<![cC]opyright )"
+bool isPrecededByCopyrightWord(const Input &input, int position)
+{
+    return position >= 10 && input.at(position - 1) == ' ' && isCopyrightWord(input, position - 10);
+}
+
+int skip(const Input &input, int position, bool (*predicate)(char16_t))
+{
+    while (position < input.size() && predicate(input.at(position))) {
+        ++position;
+    }
+    return position;
+}
+
+//! "([0-9]+|%{CURRENT_YEAR})": possible ends of years list, longest first
+int yearsEnds(const Input &input, int position, std::array<int, 64> &ends)
+{
+    if (!isDigit(input.at(position))) {
+        if (input.startsWith(position, "%{CURRENT_YEAR}")) {
+            ends[0] = position + 15;
+            return 1;
+        }
+        return 0;
+    }
+    int count = 0;
+    position = skip(input, position, isDigit);
+    ends[count++] = position;
+    // "(-[0-9]+| - [0-9]+| to [0-9]+|,[ ]?[0-9]+)*", all alternatives start differently
+    while (count < static_cast<int>(ends.size())) {
+        int next = -1;
+        if (input.at(position) == '-') {
+            next = position + 1;
+        } else if (input.startsWith(position, " - ")) {
+            next = position + 3;
+        } else if (input.startsWith(position, " to ")) {
+            next = position + 4;
+        } else if (input.at(position) == ',') {
+            next = input.at(position + 1) == ' ' && isDigit(input.at(position + 2)) ? position + 2 : position + 1;
+        }
+        if (next < 0 || !isDigit(input.at(next))) {
+            break;
+        }
+        position = skip(input, next, isDigit);
+        ends[count++] = position;
+    }
+    // greedy repetition is tried first
+    for (int i = 0; i < count / 2; ++i) {
+        std::swap(ends[i], ends[count - 1 - i]);
+    }
+    return count;
+}
+
+//! "([À-ſa-zA-Z\-\.]+( [À-ſa-zA-Z\-\.]+)*|%{AUTHOR})": end of name or -1
+int nameEnd(const Input &input, int position)
+{
+    if (!isNameCharacter(input.at(position))) {
+        return input.startsWith(position, "%{AUTHOR}") ? position + 9 : -1;
+    }
+    position = skip(input, position, isNameCharacter);
+    while (input.at(position) == ' ' && isNameCharacter(input.at(position + 1))) {
+        position = skip(input, position + 1, isNameCharacter);
+    }
+    return position;
+}
+
+//! "[, ]+([bB]y[ ]+)?<name>[, ]*<contact>" after the years
+bool parseNameAndContact(const Input &input, int position, CopyrightScanner::Statement &statement)
+{
+    const int separatorEnd = skip(input, position, isSeparator);
+    if (separatorEnd == position) {
+        return false;
+    }
+    position = separatorEnd;
+
+    int nameStart = position;
+    int end = -1;
+    if ((input.at(position) == 'b' || input.at(position) == 'B') && input.at(position + 1) == 'y' && input.at(position + 2) == ' ') {
+        nameStart = skip(input, position + 2, [](char16_t character) {
+            return character == ' ';
+        });
+        end = nameEnd(input, nameStart);
+    }
+    if (end < 0) {
+        nameStart = position;
+        end = nameEnd(input, nameStart);
+    }
+    if (end < 0) {
+        return false;
+    }
+    statement.name = {nameStart, end - nameStart};
+
+    // ".*" always matches, the alternative "%{EMAIL}" is never used
+    const int contactStart = skip(input, end, isSeparator);
+    int contactEnd = contactStart;
+    while (contactEnd < input.size() && input.at(contactEnd) != '\n') {
+        ++contactEnd;
+    }
+    statement.contact = {contactStart, contactEnd - contactStart};
+    statement.end = contactEnd;
+    return true;
+}
+
+//! "[, ]+<years>" followed by name and contact
+bool parseStatement(const Input &input, int position, CopyrightScanner::Statement &statement)
+{
+    const int separatorEnd = skip(input, position, isSeparator);
+    if (separatorEnd == position) {
+        return false;
+    }
+    std::array<int, 64> ends;
+    const int count = yearsEnds(input, separatorEnd, ends);
+    for (int i = 0; i < count; ++i) {
+        if (parseNameAndContact(input, ends[i], statement)) {
+            statement.years = {separatorEnd, ends[i] - separatorEnd};
+            return true;
+        }
+    }
+    return false;
+}
+
+//! tries all anchor alternatives at @p start in the order of the regular expression
+bool parseAt(const Input &input, int start, CopyrightScanner::Statement &statement)
+{
+    if (input.at(start - 1) == '"') {
+        return false;
+    }
+    const char16_t character = input.at(start);
+    std::array<int, 4> anchorEnds;
+    int anchorCount = 0;
+
+    if (character == 'S') {
+        if (input.startsWith(start, "SPDX-FileCopyrightText:")) {
+            anchorEnds[anchorCount++] = start + 23;
+        }
+    } else if (isLetterC(character)) {
+        if (!isCopyrightWord(input, start)) {
+            return false;
+        }
+        const int wordEnd = start + 9;
+        // "[cC]opyright\s*:?\s+\([cC]\)"
+        int position = skip(input, wordEnd, isSpace);
+        bool hasSpace = position > wordEnd;
+        if (input.at(position) == ':') {
+            const int colonEnd = position + 1;
+            position = skip(input, colonEnd, isSpace);
+            hasSpace = position > colonEnd;
+        }
+        if (hasSpace && input.at(position) == '(' && isLetterC(input.at(position + 1)) && input.at(position + 2) == ')') {
+            anchorEnds[anchorCount++] = position + 3;
+        }
+        // "[cC]opyright\s+©"
+        position = skip(input, wordEnd, isSpace);
+        if (position > wordEnd && input.at(position) == sCopyrightSign) {
+            anchorEnds[anchorCount++] = position + 1;
+        }
+        // "[cC]opyright(\s*:)?"
+        position = skip(input, wordEnd, isSpace);
+        if (input.at(position) == ':') {
+            anchorEnds[anchorCount++] = position + 1;
+        }
+        anchorEnds[anchorCount++] = wordEnd;
+    } else if (character == '(') {
+        if (isLetterC(input.at(start + 1)) && input.at(start + 2) == ')' && !isPrecededByCopyrightWord(input, start)) {
+            anchorEnds[anchorCount++] = start + 3;
+        }
+    } else if (character == sCopyrightSign) {
+        if (!isPrecededByCopyrightWord(input, start)) {
+            anchorEnds[anchorCount++] = start + 1;
+        }
+    } else if (character == '@') {
+        // "@[cC]opyright (Copyright \([cC]\))?"
+        if (isCopyrightWord(input, start + 1) && input.at(start + 10) == ' ') {
+            const int position = start + 11;
+            if (input.startsWith(position, "Copyright (") && isLetterC(input.at(position + 11)) && input.at(position + 12) == ')') {
+                anchorEnds[anchorCount++] = position + 13;
+            }
+            anchorEnds[anchorCount++] = position;
+        }
+        if (input.startsWith(start, "@author")) {
+            anchorEnds[anchorCount++] = start + 7;
+        }
+    }
+
+    for (int i = 0; i < anchorCount; ++i) {
+        if (parseStatement(input, anchorEnds[i], statement)) {
+            statement.start = start;
+            return true;
+        }
+    }
+    return false;
+}
+}
+
+std::optional<CopyrightScanner::Statement> CopyrightScanner::findNext(QStringView text, int from)
+{
+    const Input input(text);
+    Statement statement;
+    for (int position = from; position < input.size(); ++position) {
+        switch (input.at(position)) {
+        case 'S':
+        case 'c':
+        case 'C':
+        case '(':
+        case sCopyrightSign:
+        case '@':
+            if (parseAt(input, position, statement)) {
+                return statement;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+    return {};
+}
@@ -0,0 +1,42 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef COPYRIGHTSCANNER_H
+#define COPYRIGHTSCANNER_H
+
+#include <QStringView>
+#include <optional>
+
+/**
+ * @brief Scanner for copyright statements
+ *
+ * The scanner accepts exactly the statements that are matched by DirectoryParser::copyrightRegExp(),
+ * but avoids the backtracking regular expression engine: candidate positions are found by checking
+ * for the first characters of the statement anchors "SPDX-FileCopyrightText:", "Copyright", "(C)",
+ * "©", "@copyright" and "@author", and only at these positions years, name and contact are parsed.
+ */
+class CopyrightScanner
+{
+public:
+    struct Span {
+        int start {-1};
+        int length {0};
+    };
+    struct Statement {
+        int start {-1};
+        int end {-1}; //!< position after the statement, which always extends to the end of its line
+        Span years;
+        Span name;
+        Span contact;
+    };
+
+    /**
+     * @brief find first copyright statement that starts at or after @p from
+     */
+    static std::optional<Statement> findNext(QStringView text, int from = 0);
+};
+
+#endif
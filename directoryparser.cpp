@@ -5,11 +5,17 @@
  */
 
 #include "directoryparser.h"
+#include "approximatematcher.h"
+#include "copyrightscanner.h"
+#include "gitobjectreader.h"
 #include "skipparser.h"
+#include "spdxtagscanner.h"
+#include "tararchivereader.h"
 #include <QDebug>
 #include <QDirIterator>
 #include <QTextStream>
 #include <QVector>
+#include <limits>
 
 const QStringList DirectoryParser::s_supportedExtensions = {".cpp",  ".cc", ".c", ".h",  ".css",  ".hpp", ".qml", ".cmake", "CMakeLists.txt", ".in",  ".py", ".frag", ".vert",
                                                             ".glsl", "php", "sh", ".mm", ".java", ".kt",  ".js",  ".xml",   ".xsd",           ".xsl", ".pl", ".rb",   ".docbook", ".vue"};
@@ -23,6 +29,81 @@ bool shallIgnoreFile(const QDirIterator &iterator, const QRegularExpression &fil
 void DirectoryParser::setLicenseHeaderParser(LicenseParser parser)
 {
     m_parserType = parser;
+    m_headerVerdicts.clear();
+    m_blobVerdicts.clear();
+}
+
+void DirectoryParser::setHeaderDeduplication(bool enabled)
+{
+    m_headerDeduplication = enabled;
+}
+
+void DirectoryParser::setFileResultHandler(FileResultHandler handler, bool withChecksum)
+{
+    m_fileResultHandler = std::move(handler);
+    m_fileResultChecksums = withChecksum;
+}
+
+void DirectoryParser::setShard(int index, int count)
+{
+    Q_ASSERT(count >= 1 && index >= 0 && index < count);
+    m_shardIndex = index;
+    m_shardCount = count;
+}
+
+int DirectoryParser::shardOf(QStringView relativePath, int count)
+{
+    // FNV-1a, a stable hash is needed because shards are computed by independent processes
+    quint64 hash = 14695981039346656037ULL;
+    for (const QChar character : relativePath) {
+        hash ^= character.unicode();
+        hash *= 1099511628211ULL;
+    }
+    return static_cast<int>(hash % static_cast<quint64>(count));
+}
+
+void DirectoryParser::setProgressReporter(ProgressReporter *reporter)
+{
+    m_progressReporter = reporter;
+}
+
+void DirectoryParser::setVerbose(bool verbose)
+{
+    m_verbose = verbose;
+}
+
+bool DirectoryParser::hasSupportedExtension(const QString &fileName)
+{
+    for (const auto &ending : DirectoryParser::s_supportedExtensions) {
+        if (fileName.endsWith(ending)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DirectoryParser::isInShard(const QDir &root, const QString &filePath) const
+{
+    return m_shardCount == 1 || shardOf(root.relativeFilePath(filePath), m_shardCount) == m_shardIndex;
+}
+
+qint64 DirectoryParser::countFiles(const QString &directory, const QRegularExpression &ignoreFile) const
+{
+    qint64 count = 0;
+    const QDir root(directory);
+    QDirIterator iterator(directory, QDirIterator::Subdirectories);
+    while (iterator.hasNext()) {
+        const QString filePath = iterator.next();
+        if (!shallIgnoreFile(iterator, ignoreFile) && isInShard(root, filePath) && hasSupportedExtension(filePath)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+bool DirectoryParser::addAnnotations(const QString &directory)
+{
+    return m_registry.loadAnnotations(directory);
 }
 
 QRegularExpression DirectoryParser::spdxStatementRegExp() const
@@ -63,46 +144,126 @@ QString DirectoryParser::cleanupSpaceInCopyrightYearList(const QString &original
 
 QString DirectoryParser::unifyCopyrightStatements(const QString &originalText) const
 {
-    QString header = originalText;
-    QRegularExpression regExp = copyrightRegExp();
-    auto match = regExp.match(header);
+    static const QString spdxCopyrightTag = QStringLiteral("SPDX-FileCopyrightText: ");
+
+    // copy unmatched text and unified statements into one output buffer, the original text is never modified
+    QString header;
+    header.reserve(originalText.size() + originalText.size() / 8);
+    int copiedUntil = 0;
+    auto appendSpan = [&header, &originalText](const CopyrightScanner::Span &span) {
+        header.append(originalText.constData() + span.start, span.length);
+    };
+    while (const auto statement = CopyrightScanner::findNext(originalText, copiedUntil)) {
+        header.append(originalText.constData() + copiedUntil, statement->start - copiedUntil);
+        header.append(spdxCopyrightTag);
+        header.append(cleanupSpaceInCopyrightYearList(originalText.mid(statement->years.start, statement->years.length)));
+        header.append(QLatin1Char(' '));
+        appendSpan(statement->name);
+        header.append(QLatin1Char(' '));
+        appendSpan(statement->contact);
+        // same as trimming the unified statement, which always starts with the SPDX tag
+        while (header.back().isSpace()) {
+            header.chop(1);
+        }
+        copiedUntil = statement->end;
+    }
+    header.append(originalText.constData() + copiedUntil, originalText.size() - copiedUntil);
+    return header;
+}
 
-    while (match.hasMatch()) {
-        QString years = match.captured("years");
-        years = cleanupSpaceInCopyrightYearList(years);
-        QString name = match.captured("name");
-        QString contact = match.captured("contact");
+DirectoryParser::SpdxTags DirectoryParser::spdxTags(const QString &fileContent) const
+{
+    SpdxTags tags;
+    for (const auto &statement : SpdxTagScanner::findAll(fileContent)) {
+        const QString value = fileContent.mid(statement.valueStart, statement.valueLength);
+        if (statement.tag == SpdxTagScanner::Tag::LICENSE_IDENTIFIER) {
+            tags.licenseExpressions.append(value);
+        } else {
+            tags.copyrightTexts.append(value);
+        }
+    }
+    return tags;
+}
+
+QStringList DirectoryParser::copyrightStatements(const QString &fileContent) const
+{
+    static const QRegularExpression leadingYearsRegExp(QStringLiteral("^[0-9]{4}(\\s*(,|-|to)\\s*[0-9]{4})*"));
 
-        QString unifiedCopyright = QString("SPDX-FileCopyrightText: %1 %2 %3").arg(years).arg(name).arg(contact).trimmed();
-        header.replace(match.capturedStart(), match.capturedLength(), unifiedCopyright);
-        match = regExp.match(header, match.capturedStart() + unifiedCopyright.length());
+    // statements by position, such that both sources are merged in file order
+    QMap<int, QString> statements;
+    // tag values the copyright scanner cannot split into years, name and contact, like "the KDE authors"
+    for (const auto &statement : SpdxTagScanner::findAll(fileContent)) {
+        if (statement.tag != SpdxTagScanner::Tag::FILE_COPYRIGHT_TEXT) {
+            continue;
+        }
+        QString value = fileContent.mid(statement.valueStart, statement.valueLength).simplified();
+        const QRegularExpressionMatch years = leadingYearsRegExp.match(value);
+        if (years.hasMatch()) {
+            value.replace(0, years.capturedLength(), cleanupSpaceInCopyrightYearList(years.captured()));
+        }
+        statements.insert(statement.start, value);
     }
-    return header;
+    int position = 0;
+    while (const auto statement = CopyrightScanner::findNext(fileContent, position)) {
+        QString unified = cleanupSpaceInCopyrightYearList(fileContent.mid(statement->years.start, statement->years.length));
+        unified += QLatin1Char(' ') + fileContent.mid(statement->name.start, statement->name.length);
+        const QString contact = fileContent.mid(statement->contact.start, statement->contact.length).trimmed();
+        if (!contact.isEmpty()) {
+            unified += QLatin1Char(' ') + contact;
+        }
+        statements.insert(statement->start, unified);
+        position = statement->end;
+    }
+    return statements.values();
 }
 
 QString DirectoryParser::unifyCopyrightCommentHeader(const QString &originalText) const
 {
+    static const QRegularExpression initialLineRegExp(QStringLiteral("/(\\*)+"));
+    static const QRegularExpression finalLineRegExp(QStringLiteral("[ ]*(\\*)+/"));
+    static const QRegularExpression inBetweenLineStartRegExp(QStringLiteral("^[ \\*]+(?!(\\\\))"));
+    static const QRegularExpression inBetweenLineEndRegExp(QStringLiteral("[ \\*]+$"));
+
     // restrict conversion to top-file comments
     if (!originalText.startsWith("/*")) {
         qWarning() << "\tFile not starting with a comment.";
         return originalText;
     }
-    auto lines = originalText.split("\n");
-    for (int i = 0; i < lines.size(); ++i) {
-        lines[i].replace(QRegularExpression("/(\\*)+"), "/*"); // initial comment line
-        if (lines[i].startsWith("/*")) {
-            continue; // do not further modify first line
+
+    // only lines of the leading comment are normalized, the remaining text is copied as is
+    QString text;
+    text.reserve(originalText.size());
+    QString line;
+    int lineBegin = 0;
+    bool commentClosed = false;
+    while (!commentClosed && lineBegin < originalText.size()) {
+        int lineEnd = originalText.indexOf(QLatin1Char('\n'), lineBegin);
+        const bool hasNewline = lineEnd >= 0;
+        if (!hasNewline) {
+            lineEnd = originalText.size();
         }
-        lines[i].replace(QRegularExpression("[ ]*(\\*)+/"), "*/"); // final comment line
-        if (lines[i].startsWith("*/")) {
-            break;
+        line.resize(0);
+        line.append(originalText.constData() + lineBegin, lineEnd - lineBegin);
+        commentClosed = line.indexOf(QLatin1String("*/"), lineBegin == 0 ? 2 : 0) >= 0;
+
+        line.replace(initialLineRegExp, QStringLiteral("/*"));
+        if (!line.startsWith(QLatin1String("/*"))) { // do not further modify first line
+            line.replace(finalLineRegExp, QStringLiteral("*/"));
+            if (!line.startsWith(QLatin1String("*/"))) {
+                // invariant: the line is guaranteed to be a part of multiline comment
+                line.replace(inBetweenLineStartRegExp, QStringLiteral("    "));
+                line.replace(inBetweenLineEndRegExp, QString());
+            }
         }
-        // invariant: the following line is guaranteed to be a port of multiline comment
-        lines[i].replace(QRegularExpression("^[ \\*]+(?!(\\\\))"), "    "); // in-between line
-        lines[i].replace(QRegularExpression("[ \\*]+$"), ""); // in-between line
+        text.append(line);
+        if (hasNewline) {
+            text.append(QLatin1Char('\n'));
+        }
+        lineBegin = lineEnd + 1;
+    }
+    if (lineBegin < originalText.size()) {
+        text.append(originalText.constData() + lineBegin, originalText.size() - lineBegin);
     }
-    QString text = lines.join("\n");
-    //qDebug() << text;
     return text;
 }
 
@@ -128,25 +289,64 @@ QString DirectoryParser::replaceHeaderText(const QString &fileContent, const QSt
     return newContent;
 }
 
-LicenseRegistry::SpdxExpression DirectoryParser::detectSpdxLicenseStatement(const QString &fileContent) const
+QString DirectoryParser::replaceHeaderText(const QString &fileContent, const LicenseMatch &match) const
+{
+    QString outputExpression = match.expression;
+    outputExpression.replace('_', ' ');
+    static const QString spdxPrefix = QStringLiteral("SPDX-License-Identifier: ");
+
+    QString newContent;
+    newContent.reserve(fileContent.size() - match.length + spdxPrefix.size() + outputExpression.size());
+    newContent.append(fileContent.constData(), match.start);
+    newContent.append(spdxPrefix);
+    newContent.append(outputExpression);
+    const int matchEnd = match.start + match.length;
+    newContent.append(fileContent.constData() + matchEnd, fileContent.size() - matchEnd);
+    return newContent;
+}
+
+std::optional<DirectoryParser::LicenseMatch> DirectoryParser::detectSpdxLicenseStatementMatch(const QString &fileContent) const
 {
-    QRegularExpression regExp = spdxStatementRegExp();
-    auto match = regExp.match(fileContent);
-    if (match.hasMatch()) {
-        // TODO this very simple solution only works for SPDX expressions in our database
-        // should be made more general
-        return match.captured("expression").replace(' ', '_');
+    std::optional<LicenseMatch> match;
+    QStringList expressions;
+    for (const auto &statement : SpdxTagScanner::findAll(fileContent)) {
+        if (statement.tag != SpdxTagScanner::Tag::LICENSE_IDENTIFIER) {
+            continue;
+        }
+        QString expression = fileContent.mid(statement.valueStart, statement.valueLength).replace(QLatin1Char(' '), QLatin1Char('_'));
+        if (expressions.contains(expression)) {
+            continue;
+        }
+        if (!match) {
+            // the statement is never replaced, thus the position of the first tag is sufficient
+            match = LicenseMatch {QString(), -1, statement.start, statement.end - statement.start};
+        }
+        expressions.append(expression);
     }
-    return QString();
+    if (!match) {
+        return {};
+    }
+    if (expressions.size() == 1) {
+        match->expression = expressions.first();
+    } else {
+        for (auto &expression : expressions) {
+            if (expression.contains(QLatin1String("_OR_"))) {
+                expression = QLatin1Char('(') + expression + QLatin1Char(')');
+            }
+        }
+        match->expression = expressions.join(QLatin1String("_AND_"));
+    }
+    return match;
 }
 
-QVector<LicenseRegistry::SpdxExpression> DirectoryParser::pruneLicenseList(const QVector<LicenseRegistry::SpdxExpression> &inputLicenses) const
+LicenseRegistry::SpdxExpression DirectoryParser::detectSpdxLicenseStatement(const QString &fileContent) const
 {
-    // TODO
-    // - handle AND combinations
-    // - handle complex OR combinations
-    // - revisit operator preference order in SPDX and implement it here
+    const auto match = detectSpdxLicenseStatementMatch(fileContent);
+    return match ? match->expression : QString();
+}
 
+QVector<LicenseRegistry::SpdxExpression> DirectoryParser::pruneLicenseList(const QVector<LicenseRegistry::SpdxExpression> &inputLicenses) const
+{
     if (inputLicenses.length() == 1) {
         return inputLicenses;
     }
@@ -157,168 +357,404 @@ QVector<LicenseRegistry::SpdxExpression> DirectoryParser::pruneLicenseList(const
     // pruning step: remove duplicates
     licenses.erase(std::unique(licenses.begin(), licenses.end()), licenses.end());
 
-    // pruning step: compute which licenses are supported with SPDX expression (splitting at "OR")
-    // TODO this a very simple initial version and only works yet with simple license statements, not with multiple OR combinations
-    QMap<LicenseRegistry::SpdxExpression, QVector<LicenseRegistry::SpdxExpression>> licenseClosure;
+    // pruning step: remove equivalent expressions and expressions that are terms of other expressions
+    QVector<std::shared_ptr<const SpdxExpressionParser::Expression>> trees;
+    trees.reserve(licenses.size());
     for (const auto &license : qAsConst(licenses)) {
-        QVector<LicenseRegistry::SpdxExpression> licenseChoice = license.split("_OR_").toVector();
-
-        // remove all "WITH" statements
-        for (int i = 0; i < licenseChoice.size(); ++i) {
-            licenseChoice[i].remove(QRegularExpression("_WITH.*"));
-        }
-        licenseClosure[license] = licenseChoice;
+        trees.append(m_expressionParser.parse(license));
     }
-    QMutableVectorIterator<LicenseRegistry::SpdxExpression> iter(licenses);
-    while (iter.hasNext()) {
-        bool licensedContainedInClosure {false};
-        LicenseRegistry::SpdxExpression expression = iter.next();
-        for (auto iter = licenseClosure.begin(); iter != licenseClosure.end(); ++iter) {
-            if (expression != iter.key() && iter.value().contains(expression)) {
-                licensedContainedInClosure = true;
+    QVector<LicenseRegistry::SpdxExpression> prunedLicenses;
+    for (int i = 0; i < licenses.size(); ++i) {
+        bool redundant {false};
+        for (int j = 0; trees.at(i) && j < licenses.size() && !redundant; ++j) {
+            if (i == j || !trees.at(j)) {
+                continue;
+            }
+            const auto &tree = *trees.at(i);
+            const auto &otherTree = *trees.at(j);
+            if (SpdxExpressionParser::isEqual(otherTree, otherTree.root(), tree, tree.root())) {
+                redundant = j < i;
+            } else {
+                redundant = SpdxExpressionParser::containsTerm(otherTree, tree);
             }
         }
-        if (licensedContainedInClosure) {
-            iter.remove();
+        if (!redundant) {
+            prunedLicenses.append(licenses.at(i));
         }
     }
-    return licenses;
+    return prunedLicenses;
 }
 
 QVector<LicenseRegistry::SpdxExpression> DirectoryParser::detectLicenses(const QString &fileContent) const
+{
+    QVector<LicenseRegistry::SpdxExpression> detectedLicenses;
+    const auto matches = detectLicenseMatches(fileContent);
+    for (const auto &match : matches) {
+        detectedLicenses << match.expression;
+    }
+    return detectedLicenses;
+}
+
+QVector<DirectoryParser::LicenseMatch> DirectoryParser::detectHeaderTextMatches(const QString &fileContent) const
 {
     switch (m_parserType) {
     case DirectoryParser::LicenseParser::REGEXP_PARSER:
-        return detectLicensesRegexpParser(fileContent);
+        return detectLicenseMatchesRegexpParser(fileContent);
     case DirectoryParser::LicenseParser::SKIP_PARSER:
-        return detectLicensesSkipParser(fileContent);
+        return detectLicenseMatchesSkipParser(fileContent);
+    case DirectoryParser::LicenseParser::APPROXIMATE_PARSER:
+        // already contains the SPDX statement, if there are exact matches
+        return detectLicenseMatchesApproximateParser(fileContent);
+    case DirectoryParser::LicenseParser::TOKEN_PARSER:
+        return detectLicenseMatchesTokenParser(fileContent);
     }
     return {};
 }
 
-QVector<LicenseRegistry::SpdxExpression> DirectoryParser::detectLicensesSkipParser(const QString &fileContent) const
+QVector<DirectoryParser::LicenseMatch> DirectoryParser::detectLicenseMatches(const QString &fileContent) const
 {
-    SkipParser parser;
-    QVector<LicenseRegistry::SpdxExpression> testExpressions = m_registry.expressions();
-    QVector<LicenseRegistry::SpdxExpression> detectedLicenses;
-    for (auto expression : testExpressions) {
-        auto match = parser.findMatch(fileContent, m_registry.headerTexts(expression));
+    QVector<LicenseMatch> matches = detectHeaderTextMatches(fileContent);
+    if (m_parserType == LicenseParser::APPROXIMATE_PARSER) {
+        return matches;
+    }
+    if (const auto spdxStatement = detectSpdxLicenseStatementMatch(fileContent)) {
+        matches.append(*spdxStatement);
+    }
+    return matches;
+}
+
+QVector<LicenseRegistry::SpdxExpression> DirectoryParser::detectLicensesDeduplicated(const QString &fileContent) const
+{
+    const QStringView comment = leadingComment(fileContent);
+    thread_local QString window;
+    HeaderVerdictCache::headerWindow(comment, window);
+    if (window.isEmpty()) {
+        return detectLicenses(fileContent);
+    }
+    // license texts outside of the leading comment are only found by checking the full content
+    const int commentStart = static_cast<int>(comment.data() - fileContent.constData());
+    const int commentEnd = commentStart + static_cast<int>(comment.size());
+    if (HeaderVerdictCache::containsLicenseMarker(QStringView(fileContent).left(commentStart))
+        || HeaderVerdictCache::containsLicenseMarker(QStringView(fileContent).mid(commentEnd))) {
+        return detectLicenses(fileContent);
+    }
+
+    const quint64 fingerprint = HeaderVerdictCache::fingerprint(window);
+    auto verdict = m_headerVerdicts.lookup(fingerprint, window);
+    if (!verdict) {
+        // the verdict is computed on the unmodified comment, copyright lines included
+        verdict = detectLicenses(comment.toString());
+        m_headerVerdicts.insert(fingerprint, window, *verdict);
+    }
+    return *verdict;
+}
+
+QVector<DirectoryParser::ApproximateLicenseMatch> DirectoryParser::detectLicensesApproximate(const QString &fileContent) const
+{
+    QVector<ApproximateLicenseMatch> approximateMatches;
+    const auto matches = detectLicenseMatchesApproximateParser(fileContent);
+    for (const auto &match : matches) {
+        approximateMatches.append({match.expression, match.distance});
+    }
+    return approximateMatches;
+}
+
+QVector<DirectoryParser::LicenseMatch> DirectoryParser::detectLicenseMatchesApproximateParser(const QString &fileContent) const
+{
+    QVector<LicenseMatch> matches = detectLicenseMatchesSkipParser(fileContent);
+    if (!matches.isEmpty()) {
+        if (const auto spdxStatement = detectSpdxLicenseStatementMatch(fileContent)) {
+            matches.append(*spdxStatement);
+        }
+        return matches;
+    }
+
+    // matcher keeps compiled headers alive between files
+    thread_local ApproximateMatcher matcher;
+    matcher.setText(fileContent);
+    int bestDistance = std::numeric_limits<int>::max();
+    const QVector<LicenseRegistry::SpdxExpression> testExpressions = m_registry.expressions();
+    for (const auto &expression : testExpressions) {
+        if (m_registry.isFakeLicenseMarker(expression)) {
+            continue;
+        }
+        const QVector<QString> headers = m_registry.headerTexts(expression);
+        std::optional<ApproximateMatcher::Match> match;
+        int templateIndex = -1;
+        for (int i = 0; i < headers.size(); ++i) {
+            const auto headerMatch = matcher.findMatch(headers.at(i));
+            if (headerMatch && (!match || headerMatch->distance < match->distance)) {
+                match = headerMatch;
+                templateIndex = i;
+                if (match->distance == 0) {
+                    break;
+                }
+            }
+        }
+        if (!match || match->distance > bestDistance) {
+            continue;
+        }
+        if (match->distance < bestDistance) {
+            matches.clear();
+            bestDistance = match->distance;
+        }
+        matches.append({expression, templateIndex, match->start, match->end - match->start + 1, match->distance});
+    }
+    return matches;
+}
+
+QMap<QString, int> DirectoryParser::editDistances() const
+{
+    return m_editDistances;
+}
+
+std::optional<SimilarityIndex::Match> DirectoryParser::suggestLicense(const QString &fileContent) const
+{
+    return m_registry.similarityIndex().findNearest(leadingComment(fileContent));
+}
+
+QString DirectoryParser::errorString() const
+{
+    return m_errorString;
+}
+
+QMap<QString, SimilarityIndex::Match> DirectoryParser::unknownLicenseSuggestions() const
+{
+    return m_unknownLicenseSuggestions;
+}
+
+QStringView DirectoryParser::leadingComment(QStringView fileContent)
+{
+    constexpr int maxLength = 16 * 1024;
+    constexpr int fallbackLength = 4 * 1024;
+    int begin = 0;
+    while (begin < fileContent.size() && fileContent.at(begin).isSpace()) {
+        ++begin;
+    }
+    const QStringView content = fileContent.mid(begin, maxLength);
+
+    auto blockComment = [content](QLatin1String start, QLatin1String end) -> QStringView {
+        const auto endIndex = content.indexOf(end, start.size());
+        return endIndex < 0 ? content : content.left(endIndex + end.size());
+    };
+    if (content.startsWith(QLatin1String("/*"))) {
+        return blockComment(QLatin1String("/*"), QLatin1String("*/"));
+    }
+    if (content.startsWith(QLatin1String("<!--"))) {
+        return blockComment(QLatin1String("<!--"), QLatin1String("-->"));
+    }
+
+    // sequence of lines that all start with the same line comment marker
+    for (const QLatin1String marker : {QLatin1String("//"), QLatin1String("#"), QLatin1String("--"), QLatin1String(";")}) {
+        if (!content.startsWith(marker)) {
+            continue;
+        }
+        qsizetype lineBegin = 0;
+        while (lineBegin < content.size()) {
+            qsizetype textBegin = lineBegin;
+            while (textBegin < content.size() && (content.at(textBegin) == QLatin1Char(' ') || content.at(textBegin) == QLatin1Char('\t'))) {
+                ++textBegin;
+            }
+            if (!content.mid(textBegin).startsWith(marker)) {
+                break;
+            }
+            const auto lineEnd = content.indexOf(QLatin1Char('\n'), textBegin);
+            if (lineEnd < 0) {
+                return content;
+            }
+            lineBegin = lineEnd + 1;
+        }
+        return content.left(lineBegin);
+    }
+    return content.left(fallbackLength);
+}
+
+QVector<DirectoryParser::LicenseMatch> DirectoryParser::detectLicenseMatchesSkipParser(const QString &fileContent) const
+{
+    // parser keeps its pattern caches and scratch buffers alive between files
+    thread_local SkipParser parser;
+    QVector<LicenseMatch> matches;
+    const QVector<LicenseRegistry::SpdxExpression> testExpressions = m_registry.expressions();
+    for (const auto &expression : testExpressions) {
+        int templateIndex = -1;
+        const auto match = parser.findMatch(fileContent, m_registry.headerTexts(expression), &templateIndex);
         if (match) {
-            detectedLicenses << expression;
+            matches.append({expression, templateIndex, match->first, match->second - match->first + 1});
         }
     }
-    LicenseRegistry::SpdxExpression spdxStatement = detectSpdxLicenseStatement(fileContent);
-    if (!spdxStatement.isEmpty()) {
-        detectedLicenses << spdxStatement;
+    return matches;
+}
+
+QVector<DirectoryParser::LicenseMatch> DirectoryParser::detectLicenseMatchesTokenParser(const QString &fileContent) const
+{
+    const TokenMatcher &matcher = m_registry.tokenMatcher();
+    QVector<LicenseMatch> matches;
+    const auto tokenMatches = matcher.findMatches(fileContent);
+    for (const auto &match : tokenMatches) {
+        const LicenseRegistry::SpdxExpression expression = matcher.expression(match.templateIndex);
+        // all header texts of an expression are consecutive templates of the matcher
+        int firstTemplateIndex = match.templateIndex;
+        while (firstTemplateIndex > 0 && matcher.expression(firstTemplateIndex - 1) == expression) {
+            --firstTemplateIndex;
+        }
+        matches.append({expression, match.templateIndex - firstTemplateIndex, match.start, match.end - match.start + 1});
     }
-    return detectedLicenses;
+    return matches;
 }
 
-QVector<LicenseRegistry::SpdxExpression> DirectoryParser::detectLicensesRegexpParser(const QString &fileContent) const
+QVector<DirectoryParser::LicenseMatch> DirectoryParser::detectLicenseMatchesRegexpParser(const QString &fileContent) const
 {
-    QVector<LicenseRegistry::SpdxExpression> testExpressions = m_registry.expressions();
-    QVector<LicenseRegistry::SpdxExpression> detectedLicenses;
-    for (auto expression : testExpressions) {
-        auto regexps = m_registry.headerTextRegExps(expression);
-        for (auto regexp : regexps) {
-            if (fileContent.contains(regexp)) {
-                detectedLicenses << expression;
+    QVector<LicenseMatch> matches;
+    const QVector<LicenseRegistry::SpdxExpression> testExpressions = m_registry.expressions();
+    for (const auto &expression : testExpressions) {
+        const auto regexps = m_registry.headerTextRegExps(expression);
+        // every regexp is an alternation of header texts, each within its own capture group
+        int templateOffset = 0;
+        for (const auto &regexp : regexps) {
+            const QRegularExpressionMatch match = regexp.match(fileContent);
+            if (match.hasMatch()) {
+                matches.append({expression, templateOffset + match.lastCapturedIndex() - 1, match.capturedStart(), match.capturedLength()});
             }
+            templateOffset += regexp.captureCount();
         }
     }
-    LicenseRegistry::SpdxExpression spdxStatement = detectSpdxLicenseStatement(fileContent);
-    if (!spdxStatement.isEmpty()) {
-        detectedLicenses << spdxStatement;
+    return matches;
+}
+
+DirectoryParser::FileVerdict DirectoryParser::checkFile(const QString &filePath, const QString &fileContent, bool withOffsets) const
+{
+    FileVerdict verdict;
+    QVector<LicenseRegistry::SpdxExpression> licenses;
+    int editDistance = 0;
+    if (withOffsets || m_parserType == LicenseParser::APPROXIMATE_PARSER) {
+        verdict.matches = detectLicenseMatches(fileContent);
+        for (const auto &match : qAsConst(verdict.matches)) {
+            licenses << match.expression;
+            // all approximate matches share the same edit distance
+            editDistance = match.distance;
+        }
+    } else if (m_headerDeduplication) {
+        licenses = detectLicensesDeduplicated(fileContent);
+    } else {
+        licenses = detectLicenses(fileContent);
+    }
+    licenses = pruneLicenseList(licenses);
+
+    if (licenses.count() == 1) {
+        verdict.expression = licenses.first();
+        verdict.editDistance = editDistance;
+    } else if (licenses.count() > 1) {
+        qCritical() << "UNHANDLED MULTI-LICENSE CASE" << filePath << "-->" << licenses;
+        verdict.expression = LicenseRegistry::AmbigiousLicense;
+    } else {
+        // check for blacklisted file because of missing license header only when no license was detected
+        const LicenseRegistry::SpdxExpression annotation = m_registry.annotatedMissingLicense(filePath);
+        // if nothing matches, report error
+        verdict.expression = annotation.isEmpty() ? LicenseRegistry::UnknownLicense : annotation;
+        if (annotation.isEmpty()) {
+            verdict.suggestion = suggestLicense(fileContent);
+        }
+    }
+    return verdict;
+}
+
+void DirectoryParser::prepareDetection() const
+{
+    // every file is checked against the regular expressions of all expressions
+    if (m_parserType == LicenseParser::REGEXP_PARSER) {
+        m_registry.precompileHeaderTextRegExps();
+    }
+}
+
+QVector<DirectoryParser::FileVerdict> DirectoryParser::detectBuffers(const Buffer *buffers, int count, bool withOffsets) const
+{
+    prepareDetection();
+    QVector<FileVerdict> verdicts;
+    verdicts.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const Buffer &buffer = buffers[i];
+        verdicts.append(checkFile(buffer.filePath, m_contentProvider.decode(buffer.data, buffer.size), withOffsets));
+    }
+    return verdicts;
+}
+
+QVector<DirectoryParser::FileVerdict> DirectoryParser::detectBuffers(const QVector<Buffer> &buffers, bool withOffsets) const
+{
+    return detectBuffers(buffers.constData(), buffers.size(), withOffsets);
+}
+
+void DirectoryParser::storeVerdict(const QString &filePath, const FileVerdict &verdict, QMap<QString, LicenseRegistry::SpdxExpression> &results) const
+{
+    results.insert(filePath, verdict.expression);
+    if (verdict.editDistance > 0) {
+        m_editDistances.insert(filePath, verdict.editDistance);
+    }
+    if (verdict.suggestion) {
+        m_unknownLicenseSuggestions.insert(filePath, *verdict.suggestion);
     }
-    return detectedLicenses;
 }
 
 QMap<QString, LicenseRegistry::SpdxExpression> DirectoryParser::parseAll(const QString &directory, bool convertMode, const QString &ignorePattern) const
 {
+    prepareDetection();
     QVector<LicenseRegistry::SpdxExpression> expressions = m_registry.expressions();
     QMap<QString, LicenseRegistry::SpdxExpression> results;
+    m_editDistances.clear();
+    m_unknownLicenseSuggestions.clear();
+    m_headerVerdicts.clear();
+    m_errorString.clear();
 
     if (convertMode) {
         qInfo() << "Running parser in CONVERT mode: every found license will be replaced with SPDX identifiers";
     }
 
-    QStringList missingLicenseHeaderBlacklist;
-    {
-        QFile file(":/annotations/missing-headers-blacklist.txt");
-        file.open(QIODevice::ReadOnly);
-        QTextStream in(&file);
-        QString line;
-        while (in.readLineInto(&line)) {
-            missingLicenseHeaderBlacklist.append(line);
-        }
-    }
-    QStringList missingLicenseHeaderGeneratedFileBlacklist;
-    {
-        QFile file(":/annotations/generated-files.txt");
-        file.open(QIODevice::ReadOnly);
-        QTextStream in(&file);
-        QString line;
-        while (in.readLineInto(&line)) {
-            missingLicenseHeaderGeneratedFileBlacklist.append(line);
-        }
-    }
-
     QRegularExpression ignoreFile(ignorePattern);
 
+    if (m_progressReporter) {
+        m_progressReporter->start(countFiles(directory, ignoreFile));
+    }
+
+    const QDir root(directory);
     QDirIterator iterator(directory, QDirIterator::Subdirectories);
     while (iterator.hasNext()) {
         QFile file(iterator.next());
-        if (shallIgnoreFile(iterator, ignoreFile)) {
+        if (shallIgnoreFile(iterator, ignoreFile) || !isInShard(root, file.fileName()) || !hasSupportedExtension(file.fileName())) {
             continue;
         }
-
-        bool skip = true;
-        for (const auto &ending : DirectoryParser::s_supportedExtensions) {
-            if (file.fileName().endsWith(ending)) {
-                skip = false;
-                break;
-            }
-        }
-        if (skip) {
-            continue;
+        if (m_verbose) {
+            qInfo() << "Checking file:" << file.fileName();
         }
 
-        file.open(QIODevice::ReadOnly);
-        const QString fileContent = file.readAll();
-        file.close();
-
-        //        qDebug() << "checking:" << iterator.fileInfo();
-        QVector<LicenseRegistry::SpdxExpression> licenses = detectLicenses(fileContent);
-        licenses = pruneLicenseList(licenses);
+        QCryptographicHash checksum(QCryptographicHash::Sha1);
+        const QString &fileContent = m_contentProvider.read(file.fileName(), nullptr, m_fileResultChecksums ? &checksum : nullptr);
+        if (m_progressReporter) {
+            m_progressReporter->addFile(file.fileName(), iterator.fileInfo().size());
+        }
 
-        if (licenses.count() == 1) {
-            results.insert(iterator.fileInfo().filePath(), licenses.first());
-            //            qDebug() << "---> " << iterator.fileInfo().filePath() << identifier;
-        } else if (licenses.count() > 1) {
-            qCritical() << "UNHANDLED MULTI-LICENSE CASE" << iterator.fileInfo().filePath() << "-->" << licenses;
-            results[iterator.fileInfo().filePath()] = LicenseRegistry::AmbigiousLicense;
-        } else {
-            // if nothing matches, report error
-            results.insert(iterator.fileInfo().filePath(), LicenseRegistry::UnknownLicense);
+        // text positions of token based matches are not exact enough for replacing them
+        const bool convertByOffset = convertMode && (m_parserType == LicenseParser::REGEXP_PARSER || m_parserType == LicenseParser::SKIP_PARSER);
+        const FileVerdict verdict = checkFile(iterator.fileInfo().filePath(), fileContent, convertByOffset);
+        storeVerdict(iterator.fileInfo().filePath(), verdict, results);
 
-            // check for blacklisted file because of missing license header only when no license was detected
-            for (auto backlistPath : missingLicenseHeaderBlacklist) {
-                if (iterator.fileInfo().filePath().endsWith(backlistPath)) {
-                    results.insert(iterator.fileInfo().filePath(), LicenseRegistry::MissingLicense);
-                    break;
-                }
-            }
-            for (auto backlistPath : missingLicenseHeaderGeneratedFileBlacklist) {
-                if (iterator.fileInfo().filePath().endsWith(backlistPath)) {
-                    results.insert(iterator.fileInfo().filePath(), LicenseRegistry::MissingLicenseForGeneratedFile);
-                    break;
-                }
-            }
+        const QString &expression = verdict.expression;
+        if (m_fileResultHandler) {
+            m_fileResultHandler({iterator.fileInfo().filePath(), expression, fileContent, m_fileResultChecksums ? checksum.result() : QByteArray()});
         }
-
-        const QString expression = results.value(iterator.fileInfo().filePath());
         if (convertMode && !m_registry.isFakeLicenseMarker(expression)) {
-            QString newContent = replaceHeaderText(fileContent, expression);
+            QString newContent;
+            if (convertByOffset) {
+                // replace by longest match
+                const LicenseMatch *bestMatch = nullptr;
+                for (const auto &match : verdict.matches) {
+                    // SPDX statements are kept as they are
+                    if (match.expression == expression && match.templateIndex >= 0 && (!bestMatch || match.length > bestMatch->length)) {
+                        bestMatch = &match;
+                    }
+                }
+                newContent = bestMatch ? replaceHeaderText(fileContent, *bestMatch) : fileContent;
+            } else {
+                newContent = replaceHeaderText(fileContent, expression);
+            }
             // qDebug() << newContent;
             file.open(QIODevice::WriteOnly);
             file.write(newContent.toUtf8());
@@ -326,16 +762,20 @@ QMap<QString, LicenseRegistry::SpdxExpression> DirectoryParser::parseAll(const Q
         }
     }
 
+    if (m_progressReporter) {
+        m_progressReporter->finish();
+    }
+
     if (convertMode) {
         // compute needed licenses
         QSet<QString> identifiers;
-        for (const auto &expression : results.values()) {
-            auto expressionSplit = expression.split('_');
-            for (const auto &identifier : expressionSplit) {
-                // remove SPDX syntax attributes
-                if (identifier == "OR" || identifier == "AND" || identifier == "WITH") {
-                    continue;
-                }
+        for (const auto &expression : results) {
+            const auto tree = m_expressionParser.parse(expression);
+            if (!tree) {
+                qWarning() << "Could not parse SPDX expression, no license files deployed for:" << expression;
+                continue;
+            }
+            for (const auto &identifier : m_expressionParser.identifiers(*tree)) {
                 // remove special placeholders
                 if (m_registry.isFakeLicenseMarker(identifier)) {
                     continue;
@@ -356,35 +796,196 @@ QMap<QString, LicenseRegistry::SpdxExpression> DirectoryParser::parseAll(const Q
     return results;
 }
 
+QMap<QString, LicenseRegistry::SpdxExpression> DirectoryParser::parseArchive(const QString &archivePath, const QString &ignorePattern) const
+{
+    prepareDetection();
+    QMap<QString, LicenseRegistry::SpdxExpression> results;
+    m_editDistances.clear();
+    m_unknownLicenseSuggestions.clear();
+    m_headerVerdicts.clear();
+    m_errorString.clear();
+
+    QFile archive(archivePath);
+    if (!archive.open(QIODevice::ReadOnly)) {
+        m_errorString = QStringLiteral("Could not open archive %1: %2").arg(archivePath, archive.errorString());
+        qCritical().noquote() << m_errorString;
+        return results;
+    }
+    const QRegularExpression ignoreFile(ignorePattern);
+    // counting the entries would need a second pass over the archive
+    if (m_progressReporter) {
+        m_progressReporter->start(0);
+    }
+
+    TarArchiveReader reader(&archive);
+    TarArchiveReader::Entry entry;
+    QByteArray content;
+    while (reader.next(&entry)) {
+        const QString filePath = archivePath + QLatin1String("!/") + entry.path;
+        if ((!ignoreFile.pattern().isEmpty() && ignoreFile.match(filePath).hasMatch()) || (m_shardCount > 1 && shardOf(entry.path, m_shardCount) != m_shardIndex)
+            || !hasSupportedExtension(entry.path)) {
+            continue;
+        }
+        if (entry.size > std::numeric_limits<int>::max()) {
+            qWarning() << "Skipping file exceeding maximal size:" << filePath;
+            continue;
+        }
+        if (m_verbose) {
+            qInfo() << "Checking file:" << filePath;
+        }
+        if (!reader.readContent(&content)) {
+            break;
+        }
+        if (m_progressReporter) {
+            m_progressReporter->addFile(filePath, entry.size);
+        }
+
+        const QString &fileContent = m_contentProvider.decode(content.constData(), content.size());
+        const FileVerdict verdict = checkFile(filePath, fileContent);
+        storeVerdict(filePath, verdict, results);
+        if (m_fileResultHandler) {
+            m_fileResultHandler({filePath, verdict.expression, fileContent, m_fileResultChecksums ? QCryptographicHash::hash(content, QCryptographicHash::Sha1) : QByteArray()});
+        }
+    }
+    if (reader.hasError()) {
+        m_errorString = QStringLiteral("Could not read archive %1: %2").arg(archivePath, reader.errorString());
+        qCritical().noquote() << m_errorString;
+    }
+
+    if (m_progressReporter) {
+        m_progressReporter->finish();
+    }
+    return results;
+}
+
+std::optional<DirectoryParser::FileVerdict> DirectoryParser::memoizedBlobVerdict(const QByteArray &blobId, const QString &filePath) const
+{
+    const auto iter = m_blobVerdicts.constFind(blobId);
+    if (iter == m_blobVerdicts.constEnd()) {
+        return std::nullopt;
+    }
+    if (!iter->annotated) {
+        return iter->verdict;
+    }
+    // annotations for files without license header are path dependent
+    const LicenseRegistry::SpdxExpression annotation = m_registry.annotatedMissingLicense(filePath);
+    if (!annotation.isEmpty()) {
+        return FileVerdict {annotation, {}, 0, std::nullopt};
+    }
+    if (iter->verdict.expression == LicenseRegistry::UnknownLicense) {
+        return iter->verdict;
+    }
+    // the license suggestion was not computed for the annotated path
+    return std::nullopt;
+}
+
+QMap<QString, LicenseRegistry::SpdxExpression> DirectoryParser::parseGitRevision(const QString &repository, const QString &revision, const QString &ignorePattern) const
+{
+    prepareDetection();
+    QMap<QString, LicenseRegistry::SpdxExpression> results;
+    m_editDistances.clear();
+    m_unknownLicenseSuggestions.clear();
+    m_headerVerdicts.clear();
+    m_errorString.clear();
+
+    GitObjectReader reader(repository);
+    QVector<GitObjectReader::BlobEntry> blobs;
+    const QByteArray tree = reader.open() ? reader.peelToTree(reader.resolveRevision(revision)) : QByteArray();
+    if (tree.isEmpty() || !reader.listBlobs(tree, &blobs)) {
+        m_errorString = QStringLiteral("Could not read revision %1 of repository %2: %3").arg(revision, repository, reader.errorString());
+        qCritical().noquote() << m_errorString;
+        return results;
+    }
+
+    const QRegularExpression ignoreFile(ignorePattern);
+    QVector<GitObjectReader::BlobEntry> checkedBlobs;
+    for (const auto &blob : qAsConst(blobs)) {
+        const QString filePath = revision + QLatin1Char(':') + blob.path;
+        if ((ignoreFile.pattern().isEmpty() || !ignoreFile.match(filePath).hasMatch()) && (m_shardCount == 1 || shardOf(blob.path, m_shardCount) == m_shardIndex)
+            && hasSupportedExtension(blob.path)) {
+            checkedBlobs.append(blob);
+        }
+    }
+    if (m_progressReporter) {
+        m_progressReporter->start(checkedBlobs.size());
+    }
+
+    for (const auto &blob : qAsConst(checkedBlobs)) {
+        const QString filePath = revision + QLatin1Char(':') + blob.path;
+        std::optional<FileVerdict> verdict = memoizedBlobVerdict(blob.id, filePath);
+        if (m_verbose) {
+            qInfo() << "Checking file:" << filePath << (verdict ? "(unchanged blob)" : "");
+        }
+        // blob content is only needed for detection and for the file result handler
+        GitObjectReader::Object object;
+        if (!verdict || m_fileResultHandler) {
+            object = reader.readObject(blob.id);
+            if (object.type != GitObjectReader::ObjectType::BLOB) {
+                // the remaining files are still checked, but the scan is incomplete
+                if (m_errorString.isEmpty()) {
+                    m_errorString = QStringLiteral("Could not read file %1: %2").arg(filePath, reader.errorString());
+                }
+                qCritical() << "Could not read file" << filePath << ":" << reader.errorString();
+                continue;
+            }
+        }
+        const QString &fileContent = m_contentProvider.decode(object.data.constData(), object.data.size());
+        if (!verdict) {
+            verdict = checkFile(filePath, fileContent);
+            const bool annotated = verdict->expression == LicenseRegistry::UnknownLicense || verdict->expression == m_registry.annotatedMissingLicense(filePath);
+            m_blobVerdicts.insert(blob.id, {*verdict, annotated});
+        }
+        if (m_progressReporter) {
+            m_progressReporter->addFile(filePath, object.data.size());
+        }
+        storeVerdict(filePath, *verdict, results);
+        if (m_fileResultHandler) {
+            m_fileResultHandler({filePath, verdict->expression, fileContent, m_fileResultChecksums ? QCryptographicHash::hash(object.data, QCryptographicHash::Sha1) : QByteArray()});
+        }
+    }
+
+    if (m_progressReporter) {
+        m_progressReporter->finish();
+    }
+    return results;
+}
+
 void DirectoryParser::convertCopyright(const QString &directory, ConvertOptions options, const QString &ignorePattern) const
 {
     QRegularExpression ignoreFile(ignorePattern);
+    if (m_progressReporter) {
+        m_progressReporter->start(countFiles(directory, ignoreFile));
+    }
 
+    const QDir root(directory);
     QDirIterator iterator(directory, QDirIterator::Subdirectories);
     while (iterator.hasNext()) {
         QFile file(iterator.next());
+        if (!isInShard(root, file.fileName())) {
+            continue;
+        }
 
-        qInfo() << "Processing file:" << file.fileName();
+        if (m_verbose) {
+            qInfo() << "Processing file:" << file.fileName();
+        }
 
         if (shallIgnoreFile(iterator, ignoreFile)) {
-            qInfo() << "\tAsked to be ignored, skipping.";
+            if (m_verbose) {
+                qInfo() << "\tAsked to be ignored, skipping.";
+            }
             continue;
         }
-        bool skip = true;
-        for (const auto &ending : DirectoryParser::s_supportedExtensions) {
-            if (file.fileName().endsWith(ending)) {
-                skip = false;
-                break;
+        if (!hasSupportedExtension(file.fileName())) {
+            if (m_verbose) {
+                qInfo() << "\tUnsupported extension, skipping.";
             }
-        }
-        if (skip) {
-            qInfo() << "\tUnsupported extension, skipping.";
             continue;
         }
 
-        file.open(QIODevice::ReadOnly);
-        QString content = file.readAll();
-        file.close();
+        QString content = m_contentProvider.read(file.fileName());
+        if (m_progressReporter) {
+            m_progressReporter->addFile(file.fileName(), iterator.fileInfo().size());
+        }
         if (options & ConvertOption::COPYRIGHT_TEXT) {
             content = unifyCopyrightStatements(content);
         }
@@ -395,4 +996,7 @@ void DirectoryParser::convertCopyright(const QString &directory, ConvertOptions
         file.write(content.toUtf8());
         file.close();
     }
+    if (m_progressReporter) {
+        m_progressReporter->finish();
+    }
 }
@@ -7,13 +7,21 @@
 #ifndef DIRECTORYPARSER_H
 #define DIRECTORYPARSER_H
 
+#include "filecontentprovider.h"
+#include "headerverdictcache.h"
 #include "licenseregistry.h"
+#include "progressreporter.h"
+#include "spdxexpressionparser.h"
+#include <QDir>
+#include <QHash>
 #include <QRegularExpression>
+#include <functional>
+#include <optional>
 
 class DirectoryParser
 {
 public:
-    enum class LicenseParser { SKIP_PARSER, REGEXP_PARSER };
+    enum class LicenseParser { SKIP_PARSER, REGEXP_PARSER, APPROXIMATE_PARSER, TOKEN_PARSER };
     enum class ConvertOption {
         NONE = 0x0,
         LICENSE_INFO = 0x1,
@@ -21,13 +29,171 @@ public:
         PRETTY = 0x4
     };
     Q_DECLARE_FLAGS(ConvertOptions, ConvertOption)
+    struct LicenseMatch {
+        LicenseRegistry::SpdxExpression expression;
+        int templateIndex {-1}; //!< index of the matched text in LicenseRegistry::headerTexts() of the expression, -1 for SPDX statements
+        int start {-1}; //!< offset of the matched text in the file content
+        int length {0};
+        int distance {0}; //!< token edit distance for approximate matches, 0 for exact matches
+    };
+    struct FileResult {
+        QString filePath;
+        LicenseRegistry::SpdxExpression expression;
+        const QString &fileContent; //!< only valid during the call of the handler
+        QByteArray sha1; //!< SHA1 checksum of the raw file content, only set if requested
+    };
+    struct SpdxTags {
+        QStringList licenseExpressions; //!< values of SPDX-License-Identifier tags in statement syntax
+        QStringList copyrightTexts; //!< values of SPDX-FileCopyrightText tags
+    };
+    struct FileVerdict {
+        LicenseRegistry::SpdxExpression expression;
+        QVector<LicenseMatch> matches; //!< only set if requested or for the approximate parser
+        int editDistance {0}; //!< token edit distance of approximate matches
+        std::optional<SimilarityIndex::Match> suggestion; //!< most similar license if no license was detected
+    };
+    using FileResultHandler = std::function<void(const FileResult &result)>;
+    /**
+     * @brief File content that is held in memory by the caller
+     *
+     * The data is not copied and must stay valid during the call of detectBuffers().
+     */
+    struct Buffer {
+        QString filePath;
+        const char *data {nullptr}; //!< UTF-8 encoded content
+        qint64 size {0};
+    };
+    struct ApproximateLicenseMatch {
+        LicenseRegistry::SpdxExpression expression;
+        int distance; //!< token edit distance, 0 for exact matches
+    };
 
     void setLicenseHeaderParser(LicenseParser parser);
+    /**
+     * @brief Reuse license verdicts within parseAll() for files with identical header windows
+     *
+     * Enabled by default. A header window is the leading comment of a file without copyright lines.
+     * The licenses detected in the leading comment of the first file are reused for all files with the
+     * same window. Files that contain license markers outside of their leading comment are always
+     * checked completely (see HeaderVerdictCache::containsLicenseMarker()).
+     *
+     * Thus, the result differs from full detection only if a header text is interrupted by copyright
+     * lines at different positions than in the first file with the same window.
+     * @see HeaderVerdictCache
+     */
+    void setHeaderDeduplication(bool enabled);
+    /**
+     * @brief add project-local annotation lists for files without license header
+     * @see LicenseRegistry::loadAnnotations()
+     */
+    bool addAnnotations(const QString &directory);
+    /**
+     * @brief Set handler that is called by parseAll() for every checked file with its detected license
+     *
+     * This allows to stream results, e.g. into a document on disk, while the files are checked.
+     * @param handler the handler, an empty function removes the handler
+     * @param withChecksum if true, FileResult::sha1 is computed for every file
+     */
+    void setFileResultHandler(FileResultHandler handler, bool withChecksum = false);
+    /**
+     * @brief Restrict parseAll() and convertCopyright() to the files of one shard
+     *
+     * Files are partitioned by a hash of their path relative to the parsed directory, such that
+     * independent processes with the same directory layout check disjoint sets of files.
+     * @param index shard of this parser, in range [0, count)
+     * @param count number of shards, 1 disables sharding
+     */
+    void setShard(int index, int count);
+    /**
+     * @brief Report progress of parseAll() and convertCopyright() to @p reporter
+     *
+     * The files are counted before they are processed to compute the ETA.
+     * @param reporter the reporter, not owned; nullptr disables progress reporting
+     */
+    void setProgressReporter(ProgressReporter *reporter);
+    /**
+     * @brief Log every processed file and the reason for skipping files, disabled by default
+     */
+    void setVerbose(bool verbose);
+    /**
+     * @return shard of the file with path @p relativePath among @p count shards
+     */
+    static int shardOf(QStringView relativePath, int count);
+    /**
+     * @brief Detect the license of a single file, as parseAll() does for every file
+     *
+     * The verdict is one SPDX expression or a marker like UnknownLicense, AmbigiousLicense or
+     * MissingLicense.
+     * @param filePath path of the file, needed for annotations
+     * @param withOffsets if true, matches with exact text positions are computed, as needed for replacing
+     *        the license text
+     */
+    FileVerdict checkFile(const QString &filePath, const QString &fileContent, bool withOffsets = false) const;
+    /**
+     * @brief Detect the licenses of file contents that already are in memory
+     *
+     * Allows embedding applications that hold file contents to skip the file I/O of parseAll().
+     * Ignore patterns, shards and supported extensions are not considered, every buffer is checked.
+     * @param buffers pointer to the first of @p count buffers
+     * @param withOffsets see checkFile()
+     * @return one verdict per buffer, in the order of @p buffers
+     */
+    QVector<FileVerdict> detectBuffers(const Buffer *buffers, int count, bool withOffsets = false) const;
+    QVector<FileVerdict> detectBuffers(const QVector<Buffer> &buffers, bool withOffsets = false) const;
+    /**
+     * @return true if files with the name @p fileName are checked for licenses
+     */
+    static bool hasSupportedExtension(const QString &fileName);
     QMap<QString, LicenseRegistry::SpdxExpression> parseAll(const QString &directory, bool convertMode = false, const QString &ignorePattern = QString()) const;
     void convertCopyright(const QString &directory, ConvertOptions = ConvertOption::COPYRIGHT_TEXT, const QString &ignorePattern = QString()) const;
+    /**
+     * @brief Detect the licenses of all files in a tar archive without extracting it
+     *
+     * The archive may be uncompressed or gzip compressed and is read in a single pass. Only entries
+     * with supported extensions are decompressed into memory. Files are reported with paths of the
+     * form "archive.tar.gz!/path/in/archive", also to the ignore pattern and the file result handler.
+     * If the archive cannot be read completely, the results of the files read before are returned and
+     * errorString() is set.
+     * @see TarArchiveReader
+     */
+    QMap<QString, LicenseRegistry::SpdxExpression> parseArchive(const QString &archivePath, const QString &ignorePattern = QString()) const;
+    /**
+     * @brief Detect the licenses of all files of a git revision, read from the object database
+     *
+     * Nothing is checked out or written to the repository. Files are reported with paths of the form
+     * "revision:path/in/tree". Verdicts are memoized by blob id for the lifetime of the parser, such that
+     * files that did not change between revisions are detected only once. If the revision cannot be
+     * resolved or objects cannot be read, errorString() is set.
+     * @param repository working tree, git directory or bare repository
+     * @param revision full commit, tag or tree id, or a branch or tag name
+     * @see GitObjectReader
+     */
+    QMap<QString, LicenseRegistry::SpdxExpression> parseGitRevision(const QString &repository, const QString &revision, const QString &ignorePattern = QString()) const;
+    /**
+     * @brief Regular expression for copyright statements
+     *
+     * unifyCopyrightStatements() uses the equivalent CopyrightScanner, which is considerably faster.
+     */
     QRegularExpression copyrightRegExp() const;
+    /**
+     * @brief Regular expression for SPDX license statements
+     *
+     * License detection uses SpdxTagScanner instead, which only checks file headers.
+     */
     QRegularExpression spdxStatementRegExp() const;
+    /**
+     * @brief Collect all SPDX license and copyright tags of the file header in one pass
+     * @see SpdxTagScanner
+     */
+    SpdxTags spdxTags(const QString &fileContent) const;
     QString unifyCopyrightStatements(const QString &originalText) const;
+    /**
+     * @brief Collect all copyright statements in unified form "<years> <name> <contact>"
+     *
+     * Statements are reported in file order. Values of SPDX-FileCopyrightText tags in the file header
+     * that are not of this form are included with normalized white-spaces and year list.
+     */
+    QStringList copyrightStatements(const QString &fileContent) const;
     QString unifyCopyrightCommentHeader(const QString &originalText) const;
     QString cleanupSpaceInCopyrightYearList(const QString &originalYearText) const;
     /**
@@ -38,33 +204,132 @@ public:
      */
     QString replaceHeaderText(const QString &fileContent, const QString &spdxExpression) const;
 
+    /**
+     * @brief Replace the matched license text by the SPDX statement without searching again
+     * @param fileContent The input content, in which @p match was detected
+     * @param match The detected license text
+     * @return Converted file content with correct SPDX statement
+     */
+    QString replaceHeaderText(const QString &fileContent, const LicenseMatch &match) const;
+
     /**
      * @brief Detect licenses by computing all matches
      * @param fileContent the content of the file
      * @return the list of detected license matches
      */
     QVector<LicenseRegistry::SpdxExpression> detectLicenses(const QString &fileContent) const;
+
+    /**
+     * @brief Detect licenses by computing all matches, including the matched text positions
+     *
+     * Matches of the token parser and approximate matches are token aligned, i.e. they start at the first
+     * and end at the last word of the matched text, while matches of the regexp and the skip parser cover
+     * the complete matched text.
+     * @param fileContent the content of the file
+     * @return the list of detected license matches
+     */
+    QVector<LicenseMatch> detectLicenseMatches(const QString &fileContent) const;
+    /**
+     * @brief Detect expression of SPDX-License-Identifier tags in the file header
+     *
+     * Multiple tags with different expressions are combined by AND.
+     * @return the expression in registry syntax or an empty expression if there is no tag
+     */
     LicenseRegistry::SpdxExpression detectSpdxLicenseStatement(const QString &fileContent) const;
 
     /**
-     * @brief Take license liste and prune statements
+     * @brief Detect licenses while tolerating small edits in license headers
+     *
+     * Exact matches of the skip parser are preferred. Only if there are none, all license headers are
+     * matched approximately and the licenses with the smallest token edit distance are returned.
+     * @param fileContent the content of the file
+     * @return the list of best matching licenses with their edit distance
+     */
+    QVector<ApproximateLicenseMatch> detectLicensesApproximate(const QString &fileContent) const;
+
+    /**
+     * @return edit distances of approximately detected licenses by file path, from the last parseAll() run
+     */
+    QMap<QString, int> editDistances() const;
+
+    /**
+     * @brief Find the license whose header text is most similar to the leading comment of the file
      *
-     * This is a simple algorithm can handle the following cases:
-     * - license containted twice
-     * - license detacted singular and detected in OR statement as well
-     * - license detacted singular and detected in WITH statement as well
+     * This is meant as hint for files without detected license and does not replace license detection.
+     * @param fileContent the content of the file
+     * @return the most similar license with its estimated similarity, if any is sufficiently similar
+     */
+    std::optional<SimilarityIndex::Match> suggestLicense(const QString &fileContent) const;
+
+    /**
+     * @return license suggestions for files with unknown license by file path, from the last parseAll() run
+     */
+    QMap<QString, SimilarityIndex::Match> unknownLicenseSuggestions() const;
+
+    /**
+     * @return error of the last parse run, empty if the complete input was read
+     */
+    QString errorString() const;
+
+    /**
+     * @brief Extract the comment block at the beginning of a file
      *
-     * @param inputLicenses
-     * @return
+     * Block comments and sequences of line comments are recognized. If the file does not start with
+     * a comment, a fixed size prefix of the file is returned.
+     */
+    static QStringView leadingComment(QStringView fileContent);
+
+    /**
+     * @brief Take license list and prune statements
+     *
+     * Expressions are compared by their canonical syntax trees. An expression is removed if
+     * - an equivalent expression is contained earlier in the list, e.g. "A_OR_B" and "B_OR_A"
+     * - it is a term of another detected expression, e.g. "A" of "A_WITH_E_OR_B" or "A_OR_B" of "A_OR_B_OR_C"
+     *
+     * Expressions that cannot be parsed are only removed if contained twice.
+     * @param inputLicenses detected expressions of one file
+     * @return sorted list of remaining expressions
+     * @see SpdxExpressionParser::containsTerm()
      */
     QVector<LicenseRegistry::SpdxExpression> pruneLicenseList(const QVector<LicenseRegistry::SpdxExpression> &inputLicenses) const;
 
 private:
-    QVector<LicenseRegistry::SpdxExpression> detectLicensesRegexpParser(const QString &fileContent) const;
-    QVector<LicenseRegistry::SpdxExpression> detectLicensesSkipParser(const QString &fileContent) const;
+    std::optional<LicenseMatch> detectSpdxLicenseStatementMatch(const QString &fileContent) const;
+    /**
+     * @brief matches of the header texts only, for the approximate parser including the SPDX statement
+     */
+    QVector<LicenseMatch> detectHeaderTextMatches(const QString &fileContent) const;
+    QVector<LicenseMatch> detectLicenseMatchesRegexpParser(const QString &fileContent) const;
+    QVector<LicenseMatch> detectLicenseMatchesSkipParser(const QString &fileContent) const;
+    QVector<LicenseMatch> detectLicenseMatchesApproximateParser(const QString &fileContent) const;
+    QVector<LicenseMatch> detectLicenseMatchesTokenParser(const QString &fileContent) const;
+    QVector<LicenseRegistry::SpdxExpression> detectLicensesDeduplicated(const QString &fileContent) const;
+    bool isInShard(const QDir &root, const QString &filePath) const;
+    void prepareDetection() const;
+    void storeVerdict(const QString &filePath, const FileVerdict &verdict, QMap<QString, LicenseRegistry::SpdxExpression> &results) const;
+    std::optional<FileVerdict> memoizedBlobVerdict(const QByteArray &blobId, const QString &filePath) const;
+    qint64 countFiles(const QString &directory, const QRegularExpression &ignoreFile) const;
 
     LicenseRegistry m_registry;
+    FileContentProvider m_contentProvider;
+    mutable QMap<QString, int> m_editDistances;
+    mutable QMap<QString, SimilarityIndex::Match> m_unknownLicenseSuggestions;
+    mutable HeaderVerdictCache m_headerVerdicts;
+    mutable QString m_errorString;
+    struct BlobVerdict {
+        FileVerdict verdict;
+        bool annotated; //!< no license was detected in the content, thus the verdict depends on the file path
+    };
+    mutable QHash<QByteArray, BlobVerdict> m_blobVerdicts;
+    SpdxExpressionParser m_expressionParser;
     LicenseParser m_parserType {LicenseParser::REGEXP_PARSER};
+    bool m_headerDeduplication {true};
+    FileResultHandler m_fileResultHandler;
+    bool m_fileResultChecksums {false};
+    int m_shardIndex {0};
+    int m_shardCount {1};
+    ProgressReporter *m_progressReporter {nullptr};
+    bool m_verbose {false};
     static const QStringList s_supportedExtensions;
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(DirectoryParser::ConvertOptions)
@@ -0,0 +1,104 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "filecontentprovider.h"
+#include <QDebug>
+#include <QFile>
+#include <limits>
+
+namespace
+{
+struct ReadBuffers {
+    QByteArray bytes;
+    QString text;
+};
+thread_local ReadBuffers tBuffers;
+
+void decodeInto(const char *data, int length, QString &text)
+{
+    // Qt only shrinks the allocation on resize when no capacity was reserved
+    if (text.capacity() < length) {
+        text.reserve(length);
+    }
+    text.resize(length);
+    QChar *out = text.data();
+    // fast path for plain ASCII, which is widened in-place into the reused buffer
+    for (int i = 0; i < length; ++i) {
+        const char character = data[i];
+        if (static_cast<uchar>(character) >= 0x80) {
+            text = QString::fromUtf8(data, length);
+            return;
+        }
+        out[i] = QLatin1Char(character);
+    }
+}
+}
+
+FileContentProvider::FileContentProvider(qint64 mapThreshold)
+    : mMapThreshold(mapThreshold)
+{
+}
+
+const QString &FileContentProvider::read(const QString &filePath, bool *ok, QCryptographicHash *checksum) const
+{
+    if (ok) {
+        *ok = false;
+    }
+    tBuffers.text.resize(0);
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return tBuffers.text;
+    }
+    const qint64 size = file.size();
+    if (size > std::numeric_limits<int>::max()) {
+        qWarning() << "Skipping file exceeding maximal size:" << filePath;
+        return tBuffers.text;
+    }
+
+    if (size >= mMapThreshold) {
+        if (uchar *mapped = file.map(0, size)) {
+            decodeInto(reinterpret_cast<const char *>(mapped), static_cast<int>(size), tBuffers.text);
+            if (checksum) {
+                checksum->addData(QByteArray::fromRawData(reinterpret_cast<const char *>(mapped), static_cast<int>(size)));
+            }
+            file.unmap(mapped);
+            if (ok) {
+                *ok = true;
+            }
+            return tBuffers.text;
+        }
+        // fall through to buffered reading, e.g. for files on file systems without mmap support
+    }
+
+    if (tBuffers.bytes.capacity() < size) {
+        tBuffers.bytes.reserve(static_cast<int>(size));
+    }
+    tBuffers.bytes.resize(static_cast<int>(size));
+    const qint64 bytesRead = file.read(tBuffers.bytes.data(), size);
+    if (bytesRead < 0) {
+        return tBuffers.text;
+    }
+    decodeInto(tBuffers.bytes.constData(), static_cast<int>(bytesRead), tBuffers.text);
+    if (checksum) {
+        checksum->addData(QByteArray::fromRawData(tBuffers.bytes.constData(), static_cast<int>(bytesRead)));
+    }
+    if (ok) {
+        *ok = true;
+    }
+    return tBuffers.text;
+}
+
+const QString &FileContentProvider::decode(const char *data, qint64 size) const
+{
+    tBuffers.text.resize(0);
+    if (size > std::numeric_limits<int>::max()) {
+        qWarning() << "Skipping buffer exceeding maximal size";
+        return tBuffers.text;
+    }
+    decodeInto(data, static_cast<int>(size), tBuffers.text);
+    return tBuffers.text;
+}
@@ -0,0 +1,44 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef FILECONTENTPROVIDER_H
+#define FILECONTENTPROVIDER_H
+
+#include <QCryptographicHash>
+#include <QString>
+
+/**
+ * @brief Reads and decodes file contents with minimal allocations
+ *
+ * Files larger than the mapping threshold are memory-mapped and decoded directly from the mapping,
+ * smaller files are read into a per-thread buffer. Decoded text is stored in a per-thread buffer
+ * that is reused for every file read by the same thread.
+ */
+class FileContentProvider
+{
+public:
+    explicit FileContentProvider(qint64 mapThreshold = 64 * 1024);
+
+    /**
+     * @brief read file at @p filePath and decode its UTF-8 content
+     * @param filePath the file to read
+     * @param ok if set, reports whether the file could be read
+     * @param checksum if set, the raw file content is added to this hash
+     * @return decoded content, which stays valid until the next call of read() from the same thread
+     */
+    const QString &read(const QString &filePath, bool *ok = nullptr, QCryptographicHash *checksum = nullptr) const;
+
+    /**
+     * @brief decode UTF-8 content that already is in memory, e.g. provided by an embedding application
+     * @return decoded content, which stays valid until the next call of read() or decode() from the same thread
+     */
+    const QString &decode(const char *data, qint64 size) const;
+
+private:
+    const qint64 mMapThreshold;
+};
+
+#endif
@@ -0,0 +1,571 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "gitobjectreader.h"
+#include <QDir>
+#include <QFileInfo>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
+
+namespace
+{
+constexpr int sIdSize = 20;
+// git limits delta chains to a depth of 4095
+constexpr int sMaxDeltaDepth = 4096;
+constexpr int sMaxTreeDepth = 1024;
+// git limits chains of alternate object directories to a depth of 5
+constexpr int sMaxAlternatesDepth = 5;
+constexpr int sDeltaBaseCacheSize = 64 * 1024 * 1024;
+
+bool isObjectId(const QByteArray &text)
+{
+    return text.size() == 2 * sIdSize && std::all_of(text.cbegin(), text.cend(), [](char character) {
+               return (character >= '0' && character <= '9') || (character >= 'a' && character <= 'f') || (character >= 'A' && character <= 'F');
+           });
+}
+
+// inflate zlib data of known decompressed size, trailing data after the zlib stream is ignored
+bool inflateData(const uchar *data, qint64 available, qint64 size, QByteArray *output)
+{
+    if (size >= std::numeric_limits<int>::max()) {
+        return false;
+    }
+    z_stream stream {};
+    if (inflateInit(&stream) != Z_OK) {
+        return false;
+    }
+    // one spare byte lets zlib finish streams of empty objects
+    output->resize(static_cast<int>(size) + 1);
+    stream.next_in = const_cast<Bytef *>(data);
+    stream.avail_in = static_cast<uInt>(std::min<qint64>(available, std::numeric_limits<uInt>::max()));
+    stream.next_out = reinterpret_cast<Bytef *>(output->data());
+    stream.avail_out = static_cast<uInt>(output->size());
+    const int result = inflate(&stream, Z_FINISH);
+    const bool ok = result == Z_STREAM_END && static_cast<qint64>(stream.total_out) == size;
+    inflateEnd(&stream);
+    output->resize(static_cast<int>(size));
+    return ok;
+}
+
+// variable length size of delta headers, little-endian groups of seven bits
+bool readDeltaSize(const uchar *&position, const uchar *end, qint64 *value)
+{
+    *value = 0;
+    int shift = 0;
+    uchar byte = 0;
+    do {
+        if (position >= end || shift > 56) {
+            return false;
+        }
+        byte = *position++;
+        *value |= static_cast<qint64>(byte & 0x7f) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return true;
+}
+
+bool applyDelta(const QByteArray &base, const QByteArray &delta, QByteArray *result)
+{
+    const uchar *position = reinterpret_cast<const uchar *>(delta.constData());
+    const uchar *end = position + delta.size();
+    qint64 baseSize = 0;
+    qint64 resultSize = 0;
+    if (!readDeltaSize(position, end, &baseSize) || !readDeltaSize(position, end, &resultSize) || baseSize != base.size()
+        || resultSize >= std::numeric_limits<int>::max()) {
+        return false;
+    }
+    result->resize(static_cast<int>(resultSize));
+    char *output = result->data();
+    qint64 written = 0;
+    while (position < end) {
+        const uchar instruction = *position++;
+        if (instruction & 0x80) {
+            // copy from base, offset and size bytes are only present if their bit is set
+            qint64 offset = 0;
+            qint64 size = 0;
+            for (int i = 0; i < 4; ++i) {
+                if (instruction & (1 << i)) {
+                    if (position >= end) {
+                        return false;
+                    }
+                    offset |= static_cast<qint64>(*position++) << (8 * i);
+                }
+            }
+            for (int i = 0; i < 3; ++i) {
+                if (instruction & (0x10 << i)) {
+                    if (position >= end) {
+                        return false;
+                    }
+                    size |= static_cast<qint64>(*position++) << (8 * i);
+                }
+            }
+            if (size == 0) {
+                size = 0x10000;
+            }
+            if (offset + size > base.size() || written + size > resultSize) {
+                return false;
+            }
+            std::memcpy(output + written, base.constData() + offset, size);
+            written += size;
+        } else if (instruction != 0) {
+            // insert the following bytes
+            if (end - position < instruction || written + instruction > resultSize) {
+                return false;
+            }
+            std::memcpy(output + written, position, instruction);
+            position += instruction;
+            written += instruction;
+        } else {
+            return false;
+        }
+    }
+    return written == resultSize;
+}
+}
+
+GitObjectReader::GitObjectReader(const QString &repositoryPath)
+    : mRepositoryPath(repositoryPath)
+    , mDeltaBaseCache(sDeltaBaseCacheSize)
+{
+}
+
+GitObjectReader::~GitObjectReader() = default;
+
+QString GitObjectReader::errorString() const
+{
+    return mErrorString;
+}
+
+bool GitObjectReader::setError(const QString &message)
+{
+    mErrorString = message;
+    return false;
+}
+
+bool GitObjectReader::open()
+{
+    const QFileInfo dotGit(mRepositoryPath + QLatin1String("/.git"));
+    if (dotGit.isDir()) {
+        mGitDirectory = dotGit.filePath();
+    } else if (dotGit.isFile()) {
+        // linked worktrees and submodules refer to their git directory with "gitdir: <path>"
+        QFile file(dotGit.filePath());
+        if (!file.open(QIODevice::ReadOnly)) {
+            return setError(QStringLiteral("Could not read %1").arg(dotGit.filePath()));
+        }
+        const QByteArray content = file.readAll().trimmed();
+        if (!content.startsWith("gitdir: ")) {
+            return setError(QStringLiteral("Invalid git file %1").arg(dotGit.filePath()));
+        }
+        mGitDirectory = QDir(mRepositoryPath).absoluteFilePath(QString::fromUtf8(content.mid(8)));
+    } else {
+        mGitDirectory = mRepositoryPath;
+    }
+    if (!QFileInfo(mGitDirectory + QLatin1String("/objects")).isDir() || !QFileInfo::exists(mGitDirectory + QLatin1String("/HEAD"))) {
+        return setError(QStringLiteral("Not a git repository: %1").arg(mRepositoryPath));
+    }
+
+    mCommonDirectory = mGitDirectory;
+    QFile commonDirFile(mGitDirectory + QLatin1String("/commondir"));
+    if (commonDirFile.open(QIODevice::ReadOnly)) {
+        mCommonDirectory = QDir(mGitDirectory).absoluteFilePath(QString::fromUtf8(commonDirFile.readAll().trimmed()));
+    }
+
+    return addObjectDirectory(mCommonDirectory + QLatin1String("/objects"), 0);
+}
+
+bool GitObjectReader::addObjectDirectory(const QString &path, int depth)
+{
+    const QString objectDirectory = QDir(path).canonicalPath();
+    if (objectDirectory.isEmpty() || mObjectDirectories.contains(objectDirectory)) {
+        return true;
+    }
+    mObjectDirectories.append(objectDirectory);
+
+    QDir packDirectory(objectDirectory + QLatin1String("/pack"));
+    const QStringList indexes = packDirectory.entryList({QStringLiteral("pack-*.idx")}, QDir::Files, QDir::Name);
+    for (const QString &index : indexes) {
+        if (!loadPack(packDirectory.filePath(index))) {
+            return false;
+        }
+    }
+
+    // repositories cloned with --shared or --reference borrow objects from other object directories,
+    // one absolute or relative path per line
+    QFile alternates(objectDirectory + QLatin1String("/info/alternates"));
+    if (!alternates.open(QIODevice::ReadOnly)) {
+        return true;
+    }
+    if (depth >= sMaxAlternatesDepth) {
+        return setError(QStringLiteral("Too deeply nested alternate object directories in %1").arg(objectDirectory));
+    }
+    while (!alternates.atEnd()) {
+        const QByteArray line = alternates.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QString alternate = QDir(objectDirectory).absoluteFilePath(QString::fromUtf8(line));
+        if (!QFileInfo(alternate).isDir()) {
+            return setError(QStringLiteral("Alternate object directory not found: %1").arg(alternate));
+        }
+        if (!addObjectDirectory(alternate, depth + 1)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool GitObjectReader::loadPack(const QString &indexPath)
+{
+    Pack pack;
+    pack.indexFile = std::make_unique<QFile>(indexPath);
+    QString packPath = indexPath;
+    packPath.replace(packPath.size() - 4, 4, QLatin1String(".pack"));
+    pack.packFile = std::make_unique<QFile>(packPath);
+    if (!pack.packFile->exists()) {
+        // index of a pack that is being written or was removed concurrently
+        return true;
+    }
+    if (!pack.indexFile->open(QIODevice::ReadOnly) || !pack.packFile->open(QIODevice::ReadOnly)) {
+        return setError(QStringLiteral("Could not open pack %1").arg(packPath));
+    }
+    pack.indexSize = pack.indexFile->size();
+    pack.dataSize = pack.packFile->size();
+    pack.index = pack.indexFile->map(0, pack.indexSize);
+    pack.data = pack.packFile->map(0, pack.dataSize);
+    // version 2 index: magic, version, fan-out table, ids, CRCs, offsets, large offsets, checksums
+    constexpr qint64 headerSize = 8 + 256 * 4;
+    if (!pack.index || !pack.data || pack.indexSize < headerSize + 2 * sIdSize || pack.dataSize < 12 || qFromBigEndian<quint32>(pack.index) != 0xff744f63
+        || qFromBigEndian<quint32>(pack.index + 4) != 2 || std::memcmp(pack.data, "PACK", 4) != 0) {
+        return setError(QStringLiteral("Unsupported or corrupt pack %1").arg(packPath));
+    }
+    pack.count = qFromBigEndian<quint32>(pack.index + 8 + 255 * 4);
+    if (pack.indexSize < headerSize + static_cast<qint64>(pack.count) * (sIdSize + 8) + 2 * sIdSize) {
+        return setError(QStringLiteral("Corrupt pack index %1").arg(indexPath));
+    }
+    mPacks.push_back(std::move(pack));
+    return true;
+}
+
+qint64 GitObjectReader::findOffset(const Pack &pack, const QByteArray &id) const
+{
+    const uchar firstByte = static_cast<uchar>(id.at(0));
+    const uchar *fanout = pack.index + 8;
+    quint32 first = firstByte == 0 ? 0 : qFromBigEndian<quint32>(fanout + 4 * (firstByte - 1));
+    quint32 last = qFromBigEndian<quint32>(fanout + 4 * firstByte);
+    const uchar *ids = fanout + 256 * 4;
+    while (first < last) {
+        const quint32 middle = first + (last - first) / 2;
+        const int comparison = std::memcmp(ids + static_cast<qint64>(middle) * sIdSize, id.constData(), sIdSize);
+        if (comparison == 0) {
+            const uchar *offsets = ids + static_cast<qint64>(pack.count) * (sIdSize + 4);
+            const quint32 offset = qFromBigEndian<quint32>(offsets + 4 * static_cast<qint64>(middle));
+            if (!(offset & 0x80000000)) {
+                return offset;
+            }
+            // offsets beyond 2 GiB are stored in the large offset table
+            const uchar *largeOffset = offsets + 4 * static_cast<qint64>(pack.count) + 8 * static_cast<qint64>(offset & 0x7fffffff);
+            if (largeOffset + 8 > pack.index + pack.indexSize - 2 * sIdSize) {
+                return -1;
+            }
+            return static_cast<qint64>(qFromBigEndian<quint64>(largeOffset));
+        }
+        if (comparison < 0) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+    return -1;
+}
+
+bool GitObjectReader::readPackedObject(int packIndex, qint64 offset, Object *object, int depth)
+{
+    const Pack &pack = mPacks.at(packIndex);
+    if (depth > sMaxDeltaDepth) {
+        return setError(QStringLiteral("Delta chain too long"));
+    }
+    if (offset < 12 || offset >= pack.dataSize - sIdSize) {
+        return setError(QStringLiteral("Invalid pack offset"));
+    }
+    const uchar *position = pack.data + offset;
+    const uchar *end = pack.data + pack.dataSize - sIdSize;
+
+    // type and size header, followed by little-endian groups of seven bits
+    uchar byte = *position++;
+    const int type = (byte >> 4) & 0x7;
+    qint64 size = byte & 0x0f;
+    int shift = 4;
+    while (byte & 0x80) {
+        if (position >= end || shift > 56) {
+            return setError(QStringLiteral("Invalid pack object header"));
+        }
+        byte = *position++;
+        size |= static_cast<qint64>(byte & 0x7f) << shift;
+        shift += 7;
+    }
+
+    if (type >= static_cast<int>(ObjectType::COMMIT) && type <= static_cast<int>(ObjectType::TAG)) {
+        object->type = static_cast<ObjectType>(type);
+        return inflateData(position, end - position, size, &object->data) || setError(QStringLiteral("Corrupt pack object"));
+    }
+
+    Object base;
+    if (type == 6) {
+        // offset delta, base offset relative to this object
+        if (position >= end) {
+            return setError(QStringLiteral("Invalid pack object header"));
+        }
+        byte = *position++;
+        qint64 distance = byte & 0x7f;
+        while (byte & 0x80) {
+            if (position >= end || distance > (std::numeric_limits<qint64>::max() >> 8)) {
+                return setError(QStringLiteral("Invalid pack object header"));
+            }
+            byte = *position++;
+            distance = ((distance + 1) << 7) | (byte & 0x7f);
+        }
+        const QPair<int, qint64> key(packIndex, offset - distance);
+        if (const Object *cached = mDeltaBaseCache.object(key)) {
+            base = *cached;
+        } else {
+            if (!readPackedObject(packIndex, offset - distance, &base, depth + 1)) {
+                return false;
+            }
+            mDeltaBaseCache.insert(key, new Object(base), base.data.size());
+        }
+    } else if (type == 7) {
+        // reference delta, base identified by object id
+        if (end - position < sIdSize) {
+            return setError(QStringLiteral("Invalid pack object header"));
+        }
+        base = readObject(QByteArray(reinterpret_cast<const char *>(position), sIdSize), depth + 1);
+        position += sIdSize;
+        if (base.type == ObjectType::INVALID) {
+            return false;
+        }
+    } else {
+        return setError(QStringLiteral("Unknown pack object type %1").arg(type));
+    }
+
+    QByteArray delta;
+    if (!inflateData(position, end - position, size, &delta) || !applyDelta(base.data, delta, &object->data)) {
+        return setError(QStringLiteral("Corrupt delta object"));
+    }
+    object->type = base.type;
+    return true;
+}
+
+bool GitObjectReader::readLooseObject(const QByteArray &id, Object *object)
+{
+    const QString hex = QString::fromLatin1(id.toHex());
+    QFile file;
+    for (const QString &objectDirectory : qAsConst(mObjectDirectories)) {
+        file.setFileName(objectDirectory + QLatin1Char('/') + hex.left(2) + QLatin1Char('/') + hex.mid(2));
+        if (file.open(QIODevice::ReadOnly)) {
+            break;
+        }
+    }
+    if (!file.isOpen()) {
+        return setError(QStringLiteral("Object not found: %1").arg(hex));
+    }
+    const QByteArray compressed = file.readAll();
+
+    // decompressed size is only known from the header, which is part of the compressed data
+    z_stream stream {};
+    if (inflateInit(&stream) != Z_OK) {
+        return setError(QStringLiteral("Could not initialize zlib"));
+    }
+    QByteArray content;
+    content.resize(std::max(4096, compressed.size() * 4));
+    stream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(compressed.constData()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    int result = Z_OK;
+    while (result == Z_OK) {
+        if (stream.total_out == static_cast<uLong>(content.size())) {
+            content.resize(content.size() * 2);
+        }
+        stream.next_out = reinterpret_cast<Bytef *>(content.data() + stream.total_out);
+        stream.avail_out = static_cast<uInt>(content.size() - stream.total_out);
+        result = inflate(&stream, Z_NO_FLUSH);
+    }
+    content.resize(static_cast<int>(stream.total_out));
+    inflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        return setError(QStringLiteral("Corrupt loose object %1").arg(hex));
+    }
+
+    // header "<type> <size>\0"
+    const int space = content.indexOf(' ');
+    const int terminator = content.indexOf('\0');
+    if (space < 0 || terminator < space) {
+        return setError(QStringLiteral("Corrupt loose object %1").arg(hex));
+    }
+    const QByteArray type = content.left(space);
+    if (type == "commit") {
+        object->type = ObjectType::COMMIT;
+    } else if (type == "tree") {
+        object->type = ObjectType::TREE;
+    } else if (type == "blob") {
+        object->type = ObjectType::BLOB;
+    } else if (type == "tag") {
+        object->type = ObjectType::TAG;
+    } else {
+        return setError(QStringLiteral("Unknown type of loose object %1").arg(hex));
+    }
+    object->data = content.mid(terminator + 1);
+    return true;
+}
+
+GitObjectReader::Object GitObjectReader::readObject(const QByteArray &id)
+{
+    return readObject(id, 0);
+}
+
+GitObjectReader::Object GitObjectReader::readObject(const QByteArray &id, int depth)
+{
+    Object object;
+    if (id.size() != sIdSize) {
+        return object;
+    }
+    for (int i = 0; i < static_cast<int>(mPacks.size()); ++i) {
+        const qint64 offset = findOffset(mPacks.at(i), id);
+        if (offset >= 0) {
+            if (!readPackedObject(i, offset, &object, depth)) {
+                object = Object();
+            }
+            return object;
+        }
+    }
+    if (!readLooseObject(id, &object)) {
+        object = Object();
+    }
+    return object;
+}
+
+QByteArray GitObjectReader::resolveReference(const QString &name, int depth)
+{
+    if (depth > 8) {
+        return QByteArray();
+    }
+    // per-worktree references like HEAD are in the git directory, shared ones in the common directory
+    for (const QString &directory : {mGitDirectory, mCommonDirectory}) {
+        QFile file(directory + QLatin1Char('/') + name);
+        if (!QFileInfo(file).isFile() || !file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+        const QByteArray content = file.readAll().trimmed();
+        if (content.startsWith("ref: ")) {
+            return resolveReference(QString::fromUtf8(content.mid(5)), depth + 1);
+        }
+        if (isObjectId(content)) {
+            return QByteArray::fromHex(content);
+        }
+    }
+
+    if (!mPackedRefs) {
+        mPackedRefs = std::make_unique<QHash<QString, QByteArray>>();
+        QFile file(mCommonDirectory + QLatin1String("/packed-refs"));
+        if (file.open(QIODevice::ReadOnly)) {
+            // lines "<id> <reference>", peeled tags "^<id>" and comments are skipped
+            while (!file.atEnd()) {
+                const QByteArray line = file.readLine().trimmed();
+                if (line.size() > 2 * sIdSize + 1 && line.at(2 * sIdSize) == ' ' && isObjectId(line.left(2 * sIdSize))) {
+                    mPackedRefs->insert(QString::fromUtf8(line.mid(2 * sIdSize + 1)), QByteArray::fromHex(line.left(2 * sIdSize)));
+                }
+            }
+        }
+    }
+    return mPackedRefs->value(name);
+}
+
+QByteArray GitObjectReader::resolveRevision(const QString &revision)
+{
+    if (isObjectId(revision.toLatin1())) {
+        return QByteArray::fromHex(revision.toLatin1());
+    }
+    for (const char *pattern : {"%1", "refs/%1", "refs/tags/%1", "refs/heads/%1", "refs/remotes/%1", "refs/remotes/%1/HEAD"}) {
+        const QByteArray id = resolveReference(QString::fromLatin1(pattern).arg(revision), 0);
+        if (!id.isEmpty()) {
+            return id;
+        }
+    }
+    setError(QStringLiteral("Unknown revision: %1").arg(revision));
+    return QByteArray();
+}
+
+QByteArray GitObjectReader::peelToTree(const QByteArray &id)
+{
+    QByteArray current = id;
+    // annotated tags may point to other tags
+    for (int depth = 0; depth < 16; ++depth) {
+        const Object object = readObject(current);
+        switch (object.type) {
+        case ObjectType::TREE:
+            return current;
+        case ObjectType::COMMIT:
+        case ObjectType::TAG: {
+            // first header line is "tree <id>" for commits and "object <id>" for tags
+            const QByteArray field = object.type == ObjectType::COMMIT ? QByteArrayLiteral("tree ") : QByteArrayLiteral("object ");
+            const QByteArray value = object.data.mid(field.size(), 2 * sIdSize);
+            if (!object.data.startsWith(field) || !isObjectId(value)) {
+                setError(QStringLiteral("Corrupt object %1").arg(QString::fromLatin1(current.toHex())));
+                return QByteArray();
+            }
+            current = QByteArray::fromHex(value);
+            break;
+        }
+        case ObjectType::BLOB:
+            setError(QStringLiteral("Not a tree-ish object: %1").arg(QString::fromLatin1(current.toHex())));
+            return QByteArray();
+        case ObjectType::INVALID:
+            return QByteArray();
+        }
+    }
+    return QByteArray();
+}
+
+bool GitObjectReader::listBlobs(const QByteArray &treeId, QVector<BlobEntry> *blobs)
+{
+    return collectBlobs(treeId, QString(), blobs, 0);
+}
+
+bool GitObjectReader::collectBlobs(const QByteArray &treeId, const QString &prefix, QVector<BlobEntry> *blobs, int depth)
+{
+    if (depth > sMaxTreeDepth) {
+        return setError(QStringLiteral("Tree nesting too deep"));
+    }
+    const Object tree = readObject(treeId);
+    if (tree.type != ObjectType::TREE) {
+        return setError(QStringLiteral("Not a tree: %1").arg(QString::fromLatin1(treeId.toHex())));
+    }
+    // entries "<octal mode> <name>\0<raw id>"
+    int position = 0;
+    while (position < tree.data.size()) {
+        const int space = tree.data.indexOf(' ', position);
+        const int terminator = space < 0 ? -1 : tree.data.indexOf('\0', space);
+        if (terminator < 0 || terminator + 1 + sIdSize > tree.data.size()) {
+            return setError(QStringLiteral("Corrupt tree: %1").arg(QString::fromLatin1(treeId.toHex())));
+        }
+        const QByteArray mode = tree.data.mid(position, space - position);
+        const QString path = prefix + QString::fromUtf8(tree.data.mid(space + 1, terminator - space - 1));
+        const QByteArray id = tree.data.mid(terminator + 1, sIdSize);
+        position = terminator + 1 + sIdSize;
+
+        if (mode == "40000") {
+            if (!collectBlobs(id, path + QLatin1Char('/'), blobs, depth + 1)) {
+                return false;
+            }
+        } else if (mode.startsWith("100")) {
+            blobs->append({path, id});
+        }
+        // symbolic links (120000) and submodules (160000) have no content in this repository
+    }
+    return true;
+}
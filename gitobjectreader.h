@@ -0,0 +1,115 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef GITOBJECTREADER_H
+#define GITOBJECTREADER_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Minimal read-only access to the object database of a local git repository
+ *
+ * Objects are read from loose object files and from packfiles with version 2 indexes, including
+ * offset and reference deltas. Packfiles are memory-mapped. Nothing is written to the repository or
+ * its working tree.
+ *
+ * Objects of alternate object directories, as used by clones with --shared or --reference, are read
+ * as well.
+ *
+ * Revisions are resolved from full object ids, loose references and packed-refs, in the order of
+ * git rev-parse for plain names. Revision expressions like "v1.0~2" and abbreviated object ids are
+ * not supported.
+ */
+class GitObjectReader
+{
+public:
+    enum class ObjectType { INVALID = 0, COMMIT = 1, TREE = 2, BLOB = 3, TAG = 4 };
+    struct Object {
+        ObjectType type {ObjectType::INVALID};
+        QByteArray data;
+    };
+    struct BlobEntry {
+        QString path; //!< path relative to the root tree
+        QByteArray id; //!< raw 20 byte object id
+    };
+
+    /**
+     * @param repositoryPath working tree of the repository, its .git directory or a bare repository
+     */
+    explicit GitObjectReader(const QString &repositoryPath);
+    ~GitObjectReader();
+
+    /**
+     * @brief locate the git directory and map the pack indexes
+     */
+    bool open();
+
+    /**
+     * @return raw object id of @p revision, empty if it cannot be resolved
+     */
+    QByteArray resolveRevision(const QString &revision);
+
+    /**
+     * @return id of the root tree of the commit, tag or tree @p id
+     */
+    QByteArray peelToTree(const QByteArray &id);
+
+    /**
+     * @brief all regular files of the tree @p treeId and its subtrees, symbolic links and submodules are skipped
+     */
+    bool listBlobs(const QByteArray &treeId, QVector<BlobEntry> *blobs);
+
+    /**
+     * @return object with id @p id, its type is INVALID if it cannot be read
+     */
+    Object readObject(const QByteArray &id);
+
+    QString errorString() const;
+
+private:
+    struct Pack {
+        std::unique_ptr<QFile> indexFile;
+        std::unique_ptr<QFile> packFile;
+        const uchar *index {nullptr};
+        qint64 indexSize {0};
+        const uchar *data {nullptr};
+        qint64 dataSize {0};
+        quint32 count {0};
+    };
+
+    bool addObjectDirectory(const QString &path, int depth);
+    bool loadPack(const QString &indexPath);
+    qint64 findOffset(const Pack &pack, const QByteArray &id) const;
+    /**
+     * @param depth length of the delta chain that led to this object
+     */
+    Object readObject(const QByteArray &id, int depth);
+    bool readPackedObject(int packIndex, qint64 offset, Object *object, int depth);
+    bool readLooseObject(const QByteArray &id, Object *object);
+    QByteArray resolveReference(const QString &name, int depth);
+    bool collectBlobs(const QByteArray &treeId, const QString &prefix, QVector<BlobEntry> *blobs, int depth);
+    bool setError(const QString &message);
+
+    QString mRepositoryPath;
+    QString mGitDirectory;
+    QString mCommonDirectory; //!< shared directory of linked worktrees, otherwise the git directory
+    QStringList mObjectDirectories; //!< object directory of the repository followed by its alternates
+    std::vector<Pack> mPacks;
+    std::unique_ptr<QHash<QString, QByteArray>> mPackedRefs; //!< loaded on first use
+    QCache<QPair<int, qint64>, Object> mDeltaBaseCache;
+    QString mErrorString;
+};
+
+#endif
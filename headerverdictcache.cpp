@@ -0,0 +1,131 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "headerverdictcache.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+namespace
+{
+bool isCommentDecoration(QChar character)
+{
+    switch (character.unicode()) {
+    case ' ':
+    case '\t':
+    case '/':
+    case '*':
+    case '#':
+    case '-':
+    case ';':
+    case '!':
+    case '<':
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isCopyrightLine(QStringView line)
+{
+    int begin = 0;
+    while (begin < line.size() && isCommentDecoration(line.at(begin))) {
+        ++begin;
+    }
+    const QStringView text = line.mid(begin);
+    return text.startsWith(QLatin1String("Copyright")) || text.startsWith(QLatin1String("(C)"), Qt::CaseInsensitive)
+        || text.startsWith(QChar(0x00A9)) || text.startsWith(QLatin1String("SPDX-FileCopyrightText")) || text.startsWith(QLatin1String("@author"));
+}
+}
+
+void HeaderVerdictCache::headerWindow(QStringView leadingComment, QString &window)
+{
+    window.resize(0);
+    qsizetype lineBegin = 0;
+    while (lineBegin < leadingComment.size()) {
+        qsizetype lineEnd = leadingComment.indexOf(QLatin1Char('\n'), lineBegin);
+        if (lineEnd < 0) {
+            lineEnd = leadingComment.size() - 1;
+        }
+        const QStringView line = leadingComment.mid(lineBegin, lineEnd - lineBegin + 1);
+        if (!isCopyrightLine(line)) {
+            window.append(line);
+        }
+        lineBegin = lineEnd + 1;
+    }
+}
+
+bool HeaderVerdictCache::containsLicenseMarker(QStringView text)
+{
+    static const std::array<QLatin1String, 4> markers {QLatin1String("licen"), QLatin1String("redistribut"), QLatin1String("permission"), QLatin1String("gpl")};
+    return std::any_of(markers.cbegin(), markers.cend(), [text](QLatin1String marker) {
+        return text.contains(marker, Qt::CaseInsensitive);
+    });
+}
+
+quint64 HeaderVerdictCache::fingerprint(QStringView window)
+{
+    // FNV-1a over UTF-16 code units
+    quint64 hash = 0xcbf29ce484222325ULL;
+    for (const QChar character : window) {
+        hash ^= character.unicode();
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+HeaderVerdictCache::Shard &HeaderVerdictCache::shard(quint64 fingerprint) const
+{
+    return mShards[(fingerprint >> 32) % sShardCount];
+}
+
+std::optional<HeaderVerdictCache::Verdict> HeaderVerdictCache::lookup(quint64 fingerprint, QStringView window) const
+{
+    const Shard &entryShard = shard(fingerprint);
+    QMutexLocker locker(&entryShard.mutex);
+    const auto iter = entryShard.entries.constFind(fingerprint);
+    if (iter == entryShard.entries.constEnd()) {
+        return {};
+    }
+    for (const Entry &entry : iter.value()) {
+        if (QStringView(entry.window) == window) {
+            return entry.verdict;
+        }
+    }
+    return {};
+}
+
+void HeaderVerdictCache::insert(quint64 fingerprint, const QString &window, const Verdict &verdict)
+{
+    Shard &entryShard = shard(fingerprint);
+    QMutexLocker locker(&entryShard.mutex);
+    std::vector<Entry> &entries = entryShard.entries[fingerprint];
+    for (const Entry &entry : entries) {
+        if (entry.window == window) {
+            return;
+        }
+    }
+    entries.push_back({window, verdict});
+}
+
+void HeaderVerdictCache::clear()
+{
+    for (Shard &entryShard : mShards) {
+        QMutexLocker locker(&entryShard.mutex);
+        entryShard.entries.clear();
+    }
+}
+
+int HeaderVerdictCache::size() const
+{
+    int count = 0;
+    for (const Shard &entryShard : mShards) {
+        QMutexLocker locker(&entryShard.mutex);
+        for (const auto &entries : entryShard.entries) {
+            count += static_cast<int>(entries.size());
+        }
+    }
+    return count;
+}
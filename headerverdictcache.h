@@ -0,0 +1,73 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef HEADERVERDICTCACHE_H
+#define HEADERVERDICTCACHE_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <array>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Thread-safe memo of license verdicts for header windows
+ *
+ * Many files share byte-identical license headers that only differ in their copyright lines. The
+ * header window of a file is its leading comment without copyright statements, and the verdict
+ * computed for one window is reused for all further files with the same window. Windows are
+ * identified by a 64 bit fingerprint and compared in full on lookup, such that fingerprint collisions
+ * can never produce wrong verdicts.
+ *
+ * Entries are distributed over independently locked shards to keep lock contention low when files
+ * are scanned in parallel.
+ */
+class HeaderVerdictCache
+{
+public:
+    using Verdict = QVector<QString>;
+
+    /**
+     * @brief compute header window for @p leadingComment into @p window
+     *
+     * Lines starting with a copyright statement or author tag, after comment markers, are removed.
+     */
+    static void headerWindow(QStringView leadingComment, QString &window);
+
+    static quint64 fingerprint(QStringView window);
+
+    /**
+     * @brief check @p text for words that every license header text and SPDX statement contains
+     *
+     * Case-insensitive search for "licen", "redistribut", "permission" and "gpl". Text without any of
+     * these words cannot contain a license header.
+     */
+    static bool containsLicenseMarker(QStringView text);
+
+    std::optional<Verdict> lookup(quint64 fingerprint, QStringView window) const;
+    void insert(quint64 fingerprint, const QString &window, const Verdict &verdict);
+    void clear();
+    int size() const;
+
+private:
+    static constexpr int sShardCount = 16;
+    struct Entry {
+        QString window;
+        Verdict verdict;
+    };
+    struct Shard {
+        mutable QMutex mutex;
+        QHash<quint64, std::vector<Entry>> entries;
+    };
+    Shard &shard(quint64 fingerprint) const;
+
+    mutable std::array<Shard, sShardCount> mShards;
+};
+
+#endif
@@ -22,6 +22,52 @@
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QThreadPool>
+#include <algorithm>
+#include <mutex>
+
+// resources of static libraries must be registered explicitly, outside of any namespace
+static void initLicenseResources()
+{
+    Q_INIT_RESOURCE(licenses);
+    Q_INIT_RESOURCE(annotations);
+}
+
+namespace
+{
+// maximal length of a combined header text pattern, which keeps its compiled size well below the
+// limit of PCRE2 with 16 bit code units
+constexpr int sPatternLengthBudget = 24 * 1024;
+
+/**
+ * Compile the alternation of the patterns in range [begin, end). The length budget is a heuristic
+ * for the compiled size, thus a combination that still exceeds the limit is split in halves.
+ */
+void appendHeaderTextRegExps(const QVector<QString> &patterns, int begin, int end, QVector<QRegularExpression> &regexps)
+{
+    if (begin == end) {
+        return;
+    }
+    QString fullPattern;
+    for (int i = begin; i < end; ++i) {
+        if (i > begin) {
+            fullPattern.append(QLatin1Char('|'));
+        }
+        fullPattern.append(QLatin1Char('('));
+        fullPattern.append(patterns.at(i));
+        fullPattern.append(QLatin1Char(')'));
+    }
+    QRegularExpression regexp(fullPattern);
+    // isValid() compiles the pattern, such that it is not compiled when matching the first file
+    if (!regexp.isValid() && end - begin > 1) {
+        const int middle = begin + (end - begin) / 2;
+        appendHeaderTextRegExps(patterns, begin, middle, regexps);
+        appendHeaderTextRegExps(patterns, middle, end, regexps);
+        return;
+    }
+    regexps.append(regexp);
+}
+}
 
 const QString LicenseRegistry::ToClarifyLicense("TO-CLARIFY");
 const QString LicenseRegistry::UnknownLicense("UNKNOWN-LICENSE");
@@ -32,15 +78,19 @@ const QString LicenseRegistry::MissingLicenseForGeneratedFile("MISSING-LICENSE-G
 LicenseRegistry::LicenseRegistry(QObject *parent)
     : QObject(parent)
 {
-    loadLicenseHeaders();
-    loadLicenseFiles();
+    static std::once_flag resourcesInitialized;
+    std::call_once(resourcesInitialized, initLicenseResources);
+    loadAnnotations(":/annotations/");
 }
 
-void LicenseRegistry::loadLicenseHeaders()
+const QMap<LicenseRegistry::SpdxExpression, QVector<QString>> &LicenseRegistry::registry() const
+{
+    std::call_once(m_registryLoaded, &LicenseRegistry::loadLicenseHeaders, this);
+    return m_registry;
+}
+
+void LicenseRegistry::loadLicenseHeaders() const
 {
-    if (!m_registry.isEmpty()) {
-        m_registry.clear();
-    }
     m_registry[LicenseRegistry::UnknownLicense] = QVector<QString> {"THIS IS A STUB HEADER FOR UNKNOWN LICENSES, IT SHALL NEVER MATCH"};
 
     QDirIterator spdxIter(":/licenses_templates/");
@@ -65,7 +115,7 @@ void LicenseRegistry::loadLicenseHeaders()
     }
 }
 
-void LicenseRegistry::loadLicenseFiles()
+void LicenseRegistry::loadLicenseFiles() const
 {
     QDirIterator textIter(":/licensetexts/");
     while (textIter.hasNext()) {
@@ -79,39 +129,65 @@ void LicenseRegistry::loadLicenseFiles()
     }
 }
 
+bool LicenseRegistry::loadAnnotations(const QString &directory)
+{
+    const QDir annotationDir(directory);
+    bool found = m_missingLicenseAnnotations.addSuffixesFromFile(annotationDir.filePath("missing-headers-blacklist.txt"));
+    found |= m_generatedFileAnnotations.addSuffixesFromFile(annotationDir.filePath("generated-files.txt"));
+    return found;
+}
+
+LicenseRegistry::SpdxExpression LicenseRegistry::annotatedMissingLicense(const QString &filePath) const
+{
+    // generated file annotation is more specific and thus takes precedence
+    if (m_generatedFileAnnotations.matches(filePath)) {
+        return LicenseRegistry::MissingLicenseForGeneratedFile;
+    }
+    if (m_missingLicenseAnnotations.matches(filePath)) {
+        return LicenseRegistry::MissingLicense;
+    }
+    return SpdxExpression();
+}
+
 QVector<LicenseRegistry::SpdxExpression> LicenseRegistry::expressions() const
 {
-    return m_registry.keys().toVector();
+    return registry().keys().toVector();
 }
 
 QVector<LicenseRegistry::SpdxIdentifier> LicenseRegistry::identifiers() const
 {
-    return m_licenseFiles.keys().toVector();
+    return licenseFiles().keys().toVector();
 }
 
 QMap<LicenseRegistry::SpdxIdentifier, QString> LicenseRegistry::licenseFiles() const
 {
+    std::call_once(m_licenseFilesLoaded, &LicenseRegistry::loadLicenseFiles, this);
     return m_licenseFiles;
 }
 
 QVector<QString> LicenseRegistry::headerTexts(const LicenseRegistry::SpdxExpression &identifier) const
 {
-    return m_registry.value(identifier);
+    return registry().value(identifier);
 }
 
 QVector<QRegularExpression> LicenseRegistry::headerTextRegExps(const SpdxExpression &identifier) const
 {
-    if (!m_registry.contains(identifier)) {
+    if (!registry().contains(identifier)) {
         qCritical() << identifier << "identifier not found, returning error matcher";
         return QVector<QRegularExpression> {QRegularExpression("DOES_NOT_MATCH_ANY_LICENSE_HEADER")};
     }
-    if (m_regexpsCache.contains(identifier)) {
-        return m_regexpsCache.value(identifier);
+    {
+        QMutexLocker locker(&m_regexpsMutex);
+        const auto iter = m_regexpsCache.constFind(identifier);
+        if (iter != m_regexpsCache.constEnd()) {
+            return iter.value();
+        }
     }
 
+    // built without holding the lock, such that regular expressions of different expressions can be built in parallel
     QVector<QString> patterns;
     // additional to all headers also add the SPDX identifier
-    for (const QString &header : m_registry.value(identifier)) {
+    for (const QString &header : registry().value(identifier)) {
         QString pattern(QRegularExpression::escape(header));
         // start detection at first word of license string to make detection easier
         pattern.replace("\\\n", "[#\\* \\/-]*\\\n[#\\* \\t\\/-]*"); // allow prefixes and suffixes of whitespace mixed with stars or -
@@ -123,26 +199,79 @@ QVector<QRegularExpression> LicenseRegistry::headerTextRegExps(const SpdxExpress
         patterns.append(pattern);
     }
 
-    QVector<QString>::const_iterator iter = patterns.constBegin();
-    QString fullPattern = QString("(%1)").arg(*iter);
+    // templates are combined in order into alternations within the pattern length budget
     QVector<QRegularExpression> regexps;
-    QRegularExpression testExpr;
+    int chunkBegin = 0;
+    int chunkLength = 0;
+    for (int i = 0; i < patterns.size(); ++i) {
+        const int length = patterns.at(i).size() + 3;
+        if (i > chunkBegin && chunkLength + length > sPatternLengthBudget) {
+            appendHeaderTextRegExps(patterns, chunkBegin, i, regexps);
+            chunkBegin = i;
+            chunkLength = 0;
+        }
+        chunkLength += length;
+    }
+    appendHeaderTextRegExps(patterns, chunkBegin, patterns.size(), regexps);
+
+    QMutexLocker locker(&m_regexpsMutex);
+    // keep the expressions of a concurrent call, if any, such that all callers share compiled patterns
+    auto cached = m_regexpsCache.find(identifier);
+    if (cached == m_regexpsCache.end()) {
+        cached = m_regexpsCache.insert(identifier, regexps);
+    }
+    return cached.value();
+}
 
-    while (++iter != patterns.constEnd()) {
-        QString patternItem = QString("|(%1)").arg(*iter);
-        testExpr.setPattern(fullPattern + patternItem);
+void LicenseRegistry::precompileHeaderTextRegExps() const
+{
+    std::call_once(m_regexpsPrecompiled, [this]() {
+        // expressions with most header texts first, such that they do not delay the end
+        QVector<SpdxExpression> pending = expressions();
+        std::sort(pending.begin(), pending.end(), [this](const SpdxExpression &lhs, const SpdxExpression &rhs) {
+            return registry().value(lhs).size() > registry().value(rhs).size();
+        });
+        QThreadPool pool;
+        for (const SpdxExpression &expression : qAsConst(pending)) {
+            pool.start([this, expression]() {
+                headerTextRegExps(expression);
+            });
+        }
+        pool.waitForDone();
+    });
+}
 
-        if (!testExpr.isValid()) {
-            regexps += QRegularExpression(fullPattern);
-            fullPattern = QString("(%1)").arg(*iter);
-        } else {
-            fullPattern.append(patternItem);
+const TokenMatcher &LicenseRegistry::tokenMatcher() const
+{
+    std::call_once(m_tokenMatcherBuilt, [this]() {
+        m_tokenMatcher = std::make_unique<TokenMatcher>();
+        for (auto iter = registry().constBegin(); iter != registry().constEnd(); ++iter) {
+            if (isFakeLicenseMarker(iter.key())) {
+                continue;
+            }
+            for (const QString &header : iter.value()) {
+                m_tokenMatcher->addTemplate(iter.key(), header);
+            }
         }
-    }
+        m_tokenMatcher->finalize();
+    });
+    return *m_tokenMatcher;
+}
 
-    regexps += QRegularExpression(fullPattern);
-    m_regexpsCache[identifier] = regexps;
-    return regexps;
+const SimilarityIndex &LicenseRegistry::similarityIndex() const
+{
+    std::call_once(m_similarityIndexBuilt, [this]() {
+        m_similarityIndex = std::make_unique<SimilarityIndex>();
+        for (auto iter = registry().constBegin(); iter != registry().constEnd(); ++iter) {
+            if (isFakeLicenseMarker(iter.key())) {
+                continue;
+            }
+            for (const QString &header : iter.value()) {
+                m_similarityIndex->addTemplate(iter.key(), header);
+            }
+        }
+    });
+    return *m_similarityIndex;
 }
 
 bool LicenseRegistry::isFakeLicenseMarker(const QString &expression) const
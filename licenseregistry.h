@@ -7,10 +7,16 @@
 #ifndef LICENSEREGISTRY_H
 #define LICENSEREGISTRY_H
 
+#include "pathsuffixmatcher.h"
+#include "similarityindex.h"
+#include "tokenmatcher.h"
 #include <QMap>
+#include <QMutex>
 #include <QObject>
 #include <QRegularExpression>
 #include <QVector>
+#include <memory>
+#include <mutex>
 
 class LicenseRegistry : public QObject
 {
@@ -36,24 +42,89 @@ public:
      */
     QVector<SpdxIdentifier> identifiers() const;
 
+    /**
+     * @brief full license texts by SPDX identifier
+     *
+     * The license text index is only needed for deploying license files and thus built on first use.
+     */
     QMap<SpdxIdentifier, QString> licenseFiles() const;
 
     QVector<QString> headerTexts(const SpdxExpression &identifier) const;
 
+    /**
+     * @brief regular expressions for all header texts of @p identifier
+     *
+     * The expressions are built and compiled on first use for each expression, such that only regular
+     * expressions of expressions that are actually checked are created. Header texts are combined into
+     * alternations up to a fixed pattern length, each header text in its own capture group.
+     */
     QVector<QRegularExpression> headerTextRegExps(const SpdxExpression &identifier) const;
 
+    /**
+     * @brief build and compile the regular expressions of all expressions in parallel
+     *
+     * The regular expression parser checks every expression for every file, thus this avoids that
+     * the first checked file compiles all of them sequentially. Only the first call compiles, all
+     * further calls return immediately.
+     */
+    void precompileHeaderTextRegExps() const;
+
+    /**
+     * @brief token level matcher for all header texts of all expressions
+     *
+     * Header texts are tokenized into normalized word sequences on first use.
+     */
+    const TokenMatcher &tokenMatcher() const;
+
+    /**
+     * @brief MinHash similarity index over all header texts of all expressions
+     *
+     * Signatures of header texts are computed on first use.
+     */
+    const SimilarityIndex &similarityIndex() const;
+
     /**
      * @param expression is the expression to check against license strings (this does not support syntax parameters like "OR"
      * @return true if this is a non-license, e.g. "TO-CLARIFY" string"
      */
     bool isFakeLicenseMarker(const QString &expression) const;
 
+    /**
+     * @brief load annotation lists "missing-headers-blacklist.txt" and "generated-files.txt" from @p directory
+     *
+     * Annotations are added to already loaded ones. The built-in annotations are always loaded.
+     * @return true if at least one annotation list was found
+     */
+    bool loadAnnotations(const QString &directory);
+
+    /**
+     * @brief check path against the annotation lists for files that are known to have no license header
+     * @param filePath the file path, matched by suffix against the annotation entries
+     * @return MissingLicenseForGeneratedFile or MissingLicense if annotated, otherwise an empty expression
+     */
+    SpdxExpression annotatedMissingLicense(const QString &filePath) const;
+
 private:
-    void loadLicenseHeaders();
-    void loadLicenseFiles();
-    QMap<SpdxExpression, QVector<QString>> m_registry;
+    /**
+     * Components are loaded on first use, which is thread-safe. Registries of short running
+     * invocations thus only load what they need.
+     */
+    const QMap<SpdxExpression, QVector<QString>> &registry() const;
+    void loadLicenseHeaders() const;
+    void loadLicenseFiles() const;
+    PathSuffixMatcher m_missingLicenseAnnotations;
+    PathSuffixMatcher m_generatedFileAnnotations;
+    mutable std::once_flag m_registryLoaded;
+    mutable QMap<SpdxExpression, QVector<QString>> m_registry;
+    mutable QMutex m_regexpsMutex;
     mutable QMap<SpdxExpression, QVector<QRegularExpression>> m_regexpsCache;
+    mutable std::once_flag m_regexpsPrecompiled;
+    mutable std::once_flag m_licenseFilesLoaded;
     mutable QMap<SpdxIdentifier, QString> m_licenseFiles;
+    mutable std::once_flag m_tokenMatcherBuilt;
+    mutable std::unique_ptr<TokenMatcher> m_tokenMatcher;
+    mutable std::once_flag m_similarityIndexBuilt;
+    mutable std::unique_ptr<SimilarityIndex> m_similarityIndex;
 };
 
 #endif // LICENSEREGISTRY_H
@@ -0,0 +1,51 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "licensetokenizer.h"
+
+void LicenseTokenizer::tokenize(QStringView text, std::vector<Token> &tokens, int maxTokens)
+{
+    tokens.clear();
+    const int length = static_cast<int>(text.size());
+    int tokenStart = -1;
+    for (int i = 0; i < length; ++i) {
+        if (isTokenChar(text[i])) {
+            if (tokenStart < 0) {
+                tokenStart = i;
+            }
+            continue;
+        }
+        if (tokenStart >= 0) {
+            if (static_cast<int>(tokens.size()) >= maxTokens) {
+                return;
+            }
+            tokens.push_back({tokenStart, i});
+            tokenStart = -1;
+        }
+    }
+    if (tokenStart >= 0 && static_cast<int>(tokens.size()) < maxTokens) {
+        tokens.push_back({tokenStart, length});
+    }
+}
+
+quint64 LicenseTokenizer::tokenHash(QStringView token)
+{
+    // FNV-1a over case-folded UTF-16 code units
+    quint64 hash = 14695981039346656037ULL;
+    for (const QChar character : token) {
+        ushort code = character.unicode();
+        if (code < 0x80) {
+            if (code >= 'A' && code <= 'Z') {
+                code += 'a' - 'A';
+            }
+        } else {
+            code = static_cast<ushort>(QChar::toCaseFolded(static_cast<uint>(code)));
+        }
+        hash ^= code;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
@@ -0,0 +1,51 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef LICENSETOKENIZER_H
+#define LICENSETOKENIZER_H
+
+#include <QString>
+#include <QStringView>
+#include <limits>
+#include <vector>
+
+/**
+ * @brief Splits license texts into normalized word tokens
+ *
+ * Tokens are maximal runs of letters and digits. All other characters (white-spaces, comment markers
+ * and punctuation) only separate tokens. Tokens are compared case-insensitively by their hash value,
+ * such that no normalized token strings have to be created.
+ */
+class LicenseTokenizer
+{
+public:
+    struct Token {
+        int start; //!< position of first character
+        int end; //!< position after last character
+    };
+
+    /**
+     * @brief tokenize @p text into @p tokens, which is cleared before
+     * @param maxTokens stop tokenizing after this number of tokens
+     */
+    static void tokenize(QStringView text, std::vector<Token> &tokens, int maxTokens = std::numeric_limits<int>::max());
+
+    /**
+     * @return hash of case-folded @p token
+     */
+    static quint64 tokenHash(QStringView token);
+
+    static bool isTokenChar(QChar character)
+    {
+        const ushort code = character.unicode();
+        if (code < 0x80) {
+            return (code >= 'a' && code <= 'z') || (code >= 'A' && code <= 'Z') || (code >= '0' && code <= '9');
+        }
+        return character.isLetterOrNumber();
+    }
+};
+
+#endif
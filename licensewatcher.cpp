@@ -0,0 +1,234 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "licensewatcher.h"
+#include "directoryparser.h"
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <utility>
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#ifdef Q_OS_LINUX
+// file modifications are reported for the files of watched directories, thus no file watches are needed
+constexpr quint32 sWatchMask = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+#endif
+// editors and build tools usually touch files several times in a row
+constexpr int sCollectDelayMilliseconds = 200;
+}
+
+LicenseWatcher::LicenseWatcher(const DirectoryParser &parser, const QString &directory, const QString &ignorePattern, QObject *parent)
+    : QObject(parent)
+    , mParser(parser)
+    , mDirectory(QDir::cleanPath(directory))
+    , mIgnorePattern(ignorePattern)
+{
+    mCollectTimer.setSingleShot(true);
+    mCollectTimer.setInterval(sCollectDelayMilliseconds);
+    connect(&mCollectTimer, &QTimer::timeout, this, &LicenseWatcher::processPendingChanges);
+}
+
+LicenseWatcher::~LicenseWatcher()
+{
+#ifdef Q_OS_LINUX
+    if (mInotifyFd >= 0) {
+        close(mInotifyFd);
+    }
+#endif
+}
+
+bool LicenseWatcher::start()
+{
+#ifdef Q_OS_LINUX
+    mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mInotifyFd < 0) {
+        qWarning() << "Could not initialize inotify:" << std::strerror(errno);
+        return false;
+    }
+    mNotifier = new QSocketNotifier(mInotifyFd, QSocketNotifier::Read, this);
+    connect(mNotifier, &QSocketNotifier::activated, this, &LicenseWatcher::readEvents);
+
+    // watches are added before the initial scan, such that no change during the scan is missed
+    watchDirectory(mDirectory, false);
+    mResults = mParser.parseAll(mDirectory, false, mIgnorePattern.pattern());
+    return true;
+#else
+    qWarning() << "Watching directories is only supported on Linux";
+    return false;
+#endif
+}
+
+QMap<QString, LicenseRegistry::SpdxExpression> LicenseWatcher::results() const
+{
+    return mResults;
+}
+
+int LicenseWatcher::watchedDirectoryCount() const
+{
+    return mWatchedDirectories.size();
+}
+
+bool LicenseWatcher::isCandidate(const QString &filePath) const
+{
+    const QFileInfo info(filePath);
+    // same files as checked by DirectoryParser::parseAll()
+    return info.isFile() && !info.isHidden() && DirectoryParser::hasSupportedExtension(filePath)
+        && (mIgnorePattern.pattern().isEmpty() || !mIgnorePattern.match(filePath).hasMatch());
+}
+
+void LicenseWatcher::watchDirectory(const QString &path, bool checkFiles)
+{
+#ifdef Q_OS_LINUX
+    QStringList directories {path};
+    QDirIterator iterator(path, QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks, QDirIterator::Subdirectories);
+    while (iterator.hasNext()) {
+        directories.append(iterator.next());
+    }
+    for (const QString &directory : qAsConst(directories)) {
+        const int watch = inotify_add_watch(mInotifyFd, QFile::encodeName(directory).constData(), sWatchMask);
+        if (watch < 0) {
+            if (errno == ENOSPC && !mWatchLimitReported) {
+                qWarning() << "Limit of inotify watches reached, increase fs.inotify.max_user_watches to watch all directories";
+                mWatchLimitReported = true;
+            }
+            continue;
+        }
+        mWatchedDirectories.insert(watch, directory);
+        if (checkFiles) {
+            const auto entries = QDir(directory).entryInfoList(QDir::Files);
+            for (const QFileInfo &entry : entries) {
+                mPendingFiles.insert(entry.filePath());
+            }
+        }
+    }
+#else
+    Q_UNUSED(path)
+    Q_UNUSED(checkFiles)
+#endif
+}
+
+void LicenseWatcher::removeDirectory(const QString &path)
+{
+    const QString prefix = path + QLatin1Char('/');
+    for (auto iter = mWatchedDirectories.begin(); iter != mWatchedDirectories.end();) {
+        if (iter.value() == path || iter.value().startsWith(prefix)) {
+#ifdef Q_OS_LINUX
+            // watches of moved directories stay valid, but their paths are outdated
+            inotify_rm_watch(mInotifyFd, iter.key());
+#endif
+            iter = mWatchedDirectories.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    for (auto iter = mResults.lowerBound(prefix); iter != mResults.end() && iter.key().startsWith(prefix);) {
+        Q_EMIT licenseChanged(iter.key(), iter.value(), LicenseRegistry::SpdxExpression());
+        iter = mResults.erase(iter);
+    }
+}
+
+void LicenseWatcher::rescan()
+{
+    const auto results = mParser.parseAll(mDirectory, false, mIgnorePattern.pattern());
+    for (auto iter = mResults.constBegin(); iter != mResults.constEnd(); ++iter) {
+        if (!results.contains(iter.key())) {
+            Q_EMIT licenseChanged(iter.key(), iter.value(), LicenseRegistry::SpdxExpression());
+        }
+    }
+    for (auto iter = results.constBegin(); iter != results.constEnd(); ++iter) {
+        const LicenseRegistry::SpdxExpression previous = mResults.value(iter.key());
+        if (previous != iter.value()) {
+            Q_EMIT licenseChanged(iter.key(), previous, iter.value());
+        }
+    }
+    mResults = results;
+    mPendingFiles.clear();
+}
+
+void LicenseWatcher::readEvents()
+{
+#ifdef Q_OS_LINUX
+    alignas(inotify_event) char buffer[64 * 1024];
+    while (true) {
+        const ssize_t length = read(mInotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break;
+        }
+        for (const char *position = buffer; position < buffer + length;) {
+            const auto *event = reinterpret_cast<const inotify_event *>(position);
+            position += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW) {
+                qWarning() << "Too many file system events, checking all files again";
+                rescan();
+                continue;
+            }
+            if (event->mask & IN_IGNORED) {
+                mWatchedDirectories.remove(event->wd);
+                continue;
+            }
+            const QString directory = mWatchedDirectories.value(event->wd);
+            if (directory.isEmpty() || event->len == 0) {
+                continue;
+            }
+            const QString name = QFile::decodeName(event->name);
+            const QString path = directory + QLatin1Char('/') + name;
+            if (event->mask & IN_ISDIR) {
+                // hidden directories are skipped by parseAll() as well
+                if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && !name.startsWith(QLatin1Char('.'))) {
+                    watchDirectory(path, true);
+                } else if (event->mask & (IN_DELETE | IN_MOVED_FROM)) {
+                    removeDirectory(path);
+                }
+            } else {
+                mPendingFiles.insert(path);
+            }
+        }
+    }
+    if (!mPendingFiles.isEmpty()) {
+        mCollectTimer.start();
+    }
+#endif
+}
+
+void LicenseWatcher::updateFile(const QString &filePath)
+{
+    const LicenseRegistry::SpdxExpression previous = mResults.value(filePath);
+    LicenseRegistry::SpdxExpression expression;
+    if (isCandidate(filePath)) {
+        bool ok = false;
+        const QString &content = mContentProvider.read(filePath, &ok);
+        if (ok) {
+            expression = mParser.checkFile(filePath, content).expression;
+        }
+    }
+    if (expression.isEmpty()) {
+        mResults.remove(filePath);
+    } else {
+        mResults.insert(filePath, expression);
+    }
+    if (previous != expression) {
+        Q_EMIT licenseChanged(filePath, previous, expression);
+    }
+}
+
+void LicenseWatcher::processPendingChanges()
+{
+    mCollectTimer.stop();
+    const QSet<QString> files = std::exchange(mPendingFiles, {});
+    for (const QString &filePath : files) {
+        updateFile(filePath);
+    }
+}
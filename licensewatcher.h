@@ -0,0 +1,85 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef LICENSEWATCHER_H
+#define LICENSEWATCHER_H
+
+#include "filecontentprovider.h"
+#include "licenseregistry.h"
+#include <QHash>
+#include <QMap>
+#include <QObject>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTimer>
+
+class DirectoryParser;
+class QSocketNotifier;
+
+/**
+ * @brief Keeps the detected licenses of a directory tree up to date
+ *
+ * After an initial parseAll() run, only directories are watched with inotify, such that the number of
+ * watch descriptors does not grow with the number of files. Files that are written, created, moved
+ * or removed are collected for a short time and then checked again with DirectoryParser::checkFile().
+ * Every change of a license verdict is reported by licenseChanged().
+ *
+ * Watching is only supported on Linux.
+ */
+class LicenseWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    LicenseWatcher(const DirectoryParser &parser, const QString &directory, const QString &ignorePattern = QString(), QObject *parent = nullptr);
+    ~LicenseWatcher() override;
+
+    /**
+     * @brief run initial scan and start watching
+     * @return false if watching is not possible
+     */
+    bool start();
+
+    /**
+     * @brief current license verdicts of all checked files
+     */
+    QMap<QString, LicenseRegistry::SpdxExpression> results() const;
+
+    int watchedDirectoryCount() const;
+
+    /**
+     * @brief check all pending files right away instead of waiting for the collection delay
+     */
+    void processPendingChanges();
+
+Q_SIGNALS:
+    /**
+     * @param previousExpression empty for new files
+     * @param expression empty for removed files
+     */
+    void licenseChanged(const QString &filePath, const QString &previousExpression, const QString &expression);
+
+private:
+    void readEvents();
+    void watchDirectory(const QString &path, bool checkFiles);
+    void removeDirectory(const QString &path);
+    void rescan();
+    void updateFile(const QString &filePath);
+    bool isCandidate(const QString &filePath) const;
+
+    const DirectoryParser &mParser;
+    const QString mDirectory;
+    const QRegularExpression mIgnorePattern;
+    int mInotifyFd {-1};
+    QSocketNotifier *mNotifier {nullptr};
+    QHash<int, QString> mWatchedDirectories;
+    QMap<QString, LicenseRegistry::SpdxExpression> mResults;
+    QSet<QString> mPendingFiles;
+    QTimer mCollectTimer;
+    FileContentProvider mContentProvider;
+    bool mWatchLimitReported {false};
+};
+
+#endif
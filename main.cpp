@@ -5,10 +5,21 @@
  */
 
 #include "directoryparser.h"
+#include "licensewatcher.h"
+#include "reportmerger.h"
+#include "reportwriter.h"
+#include "spdxdocumentwriter.h"
+#include "tararchivereader.h"
 #include <QCommandLineParser>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <algorithm>
 #include <iostream>
+#include <optional>
+#include <unistd.h>
 
 int main(int argc, char *argv[])
 {
@@ -21,7 +32,8 @@ int main(int argc, char *argv[])
     parser.setApplicationDescription("Digs into licenses and replaces them with SPDX identifiers");
     parser.addHelpOption();
     parser.addVersionOption();
-    parser.addPositionalArgument("directory", QCoreApplication::translate("main", "Source file to copy."));
+    parser.addPositionalArgument("directory", QCoreApplication::translate("main", "Directory to dig into, or .tar, .tar.gz or .tgz archive that is scanned without extraction."));
+    parser.addPositionalArgument("merge", "merge <partial report>...: combine ndjson reports of --shard runs into one report", "[merge <partial report>...]");
 
     QCommandLineOption dryOption(QStringList() << "dry", "only show detected licenses, do not change any file");
     parser.addOption(dryOption);
@@ -29,6 +41,14 @@ int main(int argc, char *argv[])
     QCommandLineOption skipParserOption(QStringList() << "skipparser", "use skip parser variant (slower by factor ~5 currently, but maches more)");
     parser.addOption(skipParserOption);
 
+    QCommandLineOption approximateParserOption(QStringList() << "approximateparser",
+                                               "use approximate parser variant, which tolerates small edits in license headers and reports their edit distance");
+    parser.addOption(approximateParserOption);
+
+    QCommandLineOption tokenParserOption(QStringList() << "tokenparser",
+                                         "use token parser variant, which matches normalized words and ignores letter case, punctuation and line breaks");
+    parser.addOption(tokenParserOption);
+
     QCommandLineOption forceOption(QStringList() << "f"
                                                  << "force",
                                    "convert stated directory right away, do not ask");
@@ -56,6 +76,48 @@ int main(int argc, char *argv[])
                                            "");
     parser.addOption(ignorePatternOption);
 
+    QCommandLineOption annotationsOption(QStringList() << "a"
+                                                       << "annotations",
+                                         "Load additional missing-headers-blacklist.txt and generated-files.txt annotations from directory",
+                                         "annotationDirectory",
+                                         "");
+    parser.addOption(annotationsOption);
+
+    QCommandLineOption noDeduplicationOption(QStringList() << "nodedup", "check every file completely, even if a file with identical license header was already checked");
+    parser.addOption(noDeduplicationOption);
+
+    QCommandLineOption formatOption(QStringList() << "format",
+                                    "print detected licenses as machine-readable report instead of the overview: json, csv or ndjson (implies --dry without conversion options)",
+                                    "format");
+    parser.addOption(formatOption);
+
+    QCommandLineOption outputOption(QStringList() << "o"
+                                                  << "output",
+                                    "write report to file instead of standard output",
+                                    "reportFile");
+    parser.addOption(outputOption);
+
+    QCommandLineOption spdxOption(QStringList() << "spdx",
+                                  "write SPDX 2.3 document with license and copyright information of all checked files, JSON if file name ends with .json, tag-value otherwise; files are not converted",
+                                  "spdxFile");
+    parser.addOption(spdxOption);
+
+    QCommandLineOption shardOption(QStringList() << "shard",
+                                   "only check the i-th of N disjoint file sets, partitioned by path hash, e.g. 0/4 (combine ndjson reports with merge)",
+                                   "i/N");
+    parser.addOption(shardOption);
+
+    QCommandLineOption watchOption(QStringList() << "watch", "keep watching the directory after the initial scan and print every change of detected licenses");
+    parser.addOption(watchOption);
+
+    QCommandLineOption gitRevisionOption(QStringList() << "git-revision",
+                                         "check the files of a commit, tag or branch of the git repository in the directory, read from its object database without checkout",
+                                         "revision");
+    parser.addOption(gitRevisionOption);
+
+    QCommandLineOption verboseOption(QStringList() << "verbose", "log every processed file instead of showing a progress status line");
+    parser.addOption(verboseOption);
+
     parser.process(app);
 
     const QStringList args = parser.positionalArguments();
@@ -63,19 +125,232 @@ int main(int argc, char *argv[])
         qCritical() << "Required license digging directory is missing";
         return 1;
     }
+
+    auto openOutput = [&](QFile &output) {
+        if (parser.isSet(outputOption)) {
+            output.setFileName(parser.value(outputOption));
+            if (!output.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                qCritical() << "Could not open report file:" << parser.value(outputOption);
+                return false;
+            }
+        } else {
+            output.open(stdout, QIODevice::WriteOnly);
+        }
+        return true;
+    };
+
+    // combine partial reports of sharded runs
+    if (args.at(0) == QLatin1String("merge")) {
+        const auto format = ReportWriter::formatFromName(parser.isSet(formatOption) ? parser.value(formatOption) : QStringLiteral("ndjson"));
+        if (!format) {
+            qCritical() << "Unknown report format:" << parser.value(formatOption);
+            return 1;
+        }
+        ReportMerger merger;
+        for (int i = 1; i < args.count(); ++i) {
+            QFile partial(args.at(i));
+            if (!partial.open(QIODevice::ReadOnly) || !merger.addPartialReport(&partial)) {
+                qCritical() << "Could not read partial report:" << args.at(i);
+                return 1;
+            }
+        }
+        QFile output;
+        if (!openOutput(output)) {
+            return 1;
+        }
+        ReportWriter writer(*format, &output);
+        merger.write(writer);
+        return 0;
+    }
+
     const QString directory = args.at(0);
     const QString ignorePattern = parser.value(ignorePatternOption);
+    const bool archiveInput = TarArchiveReader::isArchiveFileName(directory) && QFileInfo(directory).isFile();
+    const QString gitRevision = parser.value(gitRevisionOption);
+    // archives and git revisions are scanned in memory, hence their files cannot be converted
+    const bool inMemoryInput = archiveInput || !gitRevision.isEmpty();
+    const bool conversionRequested = parser.isSet(licenseConvertOption) || parser.isSet(copyrightConvertOption) || parser.isSet(forceOption);
+    if (inMemoryInput && (conversionRequested || parser.isSet(watchOption))) {
+        qCritical() << "Archives and git revisions can only be scanned, conversion and watching require a directory:" << directory;
+        return 1;
+    }
+    // the SPDX document describes the files as they were read, checksums would not match converted files
+    if (parser.isSet(spdxOption) && (conversionRequested || parser.isSet(prettyHeaderOption))) {
+        qCritical() << "SPDX documents can only be written without file conversion";
+        return 1;
+    }
 
-    qInfo() << "Digging recursively all files in directory:" << directory;
+    if (archiveInput) {
+        qInfo() << "Digging all files in archive:" << directory;
+    } else if (!gitRevision.isEmpty()) {
+        qInfo() << "Digging all files of revision" << gitRevision << "in repository:" << directory;
+    } else {
+        qInfo() << "Digging recursively all files in directory:" << directory;
+    }
     DirectoryParser licenseParser;
     if (parser.isSet(skipParserOption)) {
         licenseParser.setLicenseHeaderParser(DirectoryParser::LicenseParser::SKIP_PARSER);
     }
+    if (parser.isSet(approximateParserOption)) {
+        licenseParser.setLicenseHeaderParser(DirectoryParser::LicenseParser::APPROXIMATE_PARSER);
+    }
+    if (parser.isSet(tokenParserOption)) {
+        licenseParser.setLicenseHeaderParser(DirectoryParser::LicenseParser::TOKEN_PARSER);
+    }
+    if (parser.isSet(noDeduplicationOption)) {
+        licenseParser.setHeaderDeduplication(false);
+    }
+    // status line is only useful on terminals and would be interleaved with per-file logs
+    ProgressReporter progressReporter;
+    if (parser.isSet(verboseOption)) {
+        licenseParser.setVerbose(true);
+    } else if (isatty(fileno(stderr))) {
+        licenseParser.setProgressReporter(&progressReporter);
+    }
+    if (parser.isSet(shardOption)) {
+        const QStringList shard = parser.value(shardOption).split(QLatin1Char('/'));
+        bool indexOk = false;
+        bool countOk = false;
+        const int index = shard.count() == 2 ? shard.at(0).toInt(&indexOk) : -1;
+        const int count = shard.count() == 2 ? shard.at(1).toInt(&countOk) : -1;
+        if (!indexOk || !countOk || count < 1 || index < 0 || index >= count) {
+            qCritical() << "Invalid shard, expected i/N with 0 <= i < N:" << parser.value(shardOption);
+            return 1;
+        }
+        licenseParser.setShard(index, count);
+    }
+    if (parser.isSet(annotationsOption) && !licenseParser.addAnnotations(parser.value(annotationsOption))) {
+        qWarning() << "No annotation files found in:" << parser.value(annotationsOption);
+    }
+
+    // SPDX document is streamed to disk by the first parseAll() run
+    QFile spdxFile;
+    std::optional<SpdxDocumentWriter> spdxWriter;
+    if (parser.isSet(spdxOption)) {
+        spdxFile.setFileName(parser.value(spdxOption));
+        if (!spdxFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "Could not open SPDX document file:" << parser.value(spdxOption);
+            return 1;
+        }
+        const QDir root(directory);
+        QString documentName = archiveInput ? QFileInfo(directory).fileName() : QFileInfo(root.absolutePath()).fileName();
+        if (!gitRevision.isEmpty()) {
+            documentName += QLatin1Char('-') + gitRevision;
+        }
+        spdxWriter.emplace(SpdxDocumentWriter::formatFromFileName(spdxFile.fileName()), &spdxFile, documentName);
+        licenseParser.setFileResultHandler(
+            [&](const DirectoryParser::FileResult &result) {
+                // archive entries are reported as "archive.tar.gz!/path/in/archive", revision files as "revision:path"
+                QString path;
+                if (archiveInput) {
+                    path = result.filePath.mid(directory.size() + 2);
+                } else if (!gitRevision.isEmpty()) {
+                    path = result.filePath.mid(gitRevision.size() + 1);
+                } else {
+                    path = root.relativeFilePath(result.filePath);
+                }
+                spdxWriter->addFile(path, result.expression, result.sha1, licenseParser.copyrightStatements(result.fileContent));
+            },
+            true);
+    }
+    auto finishSpdxDocument = [&]() {
+        if (spdxWriter) {
+            licenseParser.setFileResultHandler({});
+            spdxWriter->finish();
+            spdxWriter.reset();
+            spdxFile.close();
+        }
+    };
+    // a document of an incomplete scan is not written at all
+    auto discardSpdxDocument = [&]() {
+        if (spdxWriter) {
+            licenseParser.setFileResultHandler({});
+            spdxWriter.reset();
+            spdxFile.remove();
+        }
+    };
+
+    // continuous license status, changes are printed until the process is terminated
+    if (parser.isSet(watchOption)) {
+        LicenseWatcher watcher(licenseParser, directory, ignorePattern);
+        QObject::connect(&watcher, &LicenseWatcher::licenseChanged, [](const QString &filePath, const QString &previousExpression, const QString &expression) {
+            if (previousExpression.isEmpty()) {
+                qInfo() << filePath << " --> " << expression << "(new file)";
+            } else if (expression.isEmpty()) {
+                qInfo() << filePath << " --> " << "(removed, was" << previousExpression << ")";
+            } else {
+                qInfo() << filePath << " --> " << expression << "(was" << previousExpression << ")";
+            }
+        });
+        if (!watcher.start()) {
+            return 1;
+        }
+        finishSpdxDocument();
+        const auto results = watcher.results();
+        qInfo() << "Watching" << watcher.watchedDirectoryCount() << "directories with" << results.size() << "checked files,"
+                << std::count(results.cbegin(), results.cend(), LicenseRegistry::UnknownLicense) << "without detected license";
+        return app.exec();
+    }
+
+    auto detectLicenses = [&]() {
+        if (archiveInput) {
+            return licenseParser.parseArchive(directory, ignorePattern);
+        }
+        if (!gitRevision.isEmpty()) {
+            return licenseParser.parseGitRevision(directory, gitRevision, ignorePattern);
+        }
+        return licenseParser.parseAll(directory, false, ignorePattern);
+    };
+
+    // write machine-readable report
+    if (parser.isSet(formatOption)) {
+        const auto format = ReportWriter::formatFromName(parser.value(formatOption));
+        if (!format) {
+            qCritical() << "Unknown report format:" << parser.value(formatOption);
+            return 1;
+        }
+        QFile output;
+        if (!openOutput(output)) {
+            return 1;
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        const auto results = detectLicenses();
+        const qint64 elapsed = timer.elapsed();
+        // an incomplete scan must not look like a clean one
+        if (!licenseParser.errorString().isEmpty()) {
+            discardSpdxDocument();
+            return 1;
+        }
+        finishSpdxDocument();
+        const auto editDistances = licenseParser.editDistances();
+        const auto suggestions = licenseParser.unknownLicenseSuggestions();
+        ReportWriter writer(*format, &output);
+        for (auto iter = results.constBegin(); iter != results.constEnd(); ++iter) {
+            const auto suggestion = suggestions.constFind(iter.key());
+            writer.addFile(iter.key(),
+                           iter.value(),
+                           editDistances.value(iter.key()),
+                           suggestion != suggestions.constEnd() ? std::optional<SimilarityIndex::Match>(suggestion.value()) : std::nullopt);
+        }
+        writer.finish(elapsed);
+        if (!conversionRequested) {
+            return 0;
+        }
+    }
 
     // print overview if no parameter is set
-    if (!(parser.isSet(licenseConvertOption) || parser.isSet(copyrightConvertOption) || parser.isSet(forceOption))) {
+    if (!parser.isSet(formatOption) && !(parser.isSet(licenseConvertOption) || parser.isSet(copyrightConvertOption) || parser.isSet(forceOption))) {
         std::cout << hightlightOut << "==============================" << std::endl << "= LICENSE DETECTION OVERVIEW =" << std::endl << "==============================" << defaultOut << std::endl;
-        const auto results = licenseParser.parseAll(directory, false, ignorePattern);
+        const auto results = detectLicenses();
+        if (!licenseParser.errorString().isEmpty()) {
+            discardSpdxDocument();
+            return 1;
+        }
+        finishSpdxDocument();
+        const auto editDistances = licenseParser.editDistances();
+        const auto suggestions = licenseParser.unknownLicenseSuggestions();
         int undetectedLicenses = 0;
         int detectedLicenses = 0;
         for (auto iter = results.constBegin(); iter != results.constEnd(); iter++) {
@@ -84,11 +359,22 @@ int main(int argc, char *argv[])
             } else {
                 ++detectedLicenses;
             }
-            qInfo() << iter.key() << " --> " << iter.value();
+            if (suggestions.contains(iter.key())) {
+                const auto suggestion = suggestions.value(iter.key());
+                qInfo() << iter.key() << " --> " << iter.value() << " (most similar:" << suggestion.expression << "similarity:" << suggestion.similarity << ")";
+            } else if (editDistances.contains(iter.key())) {
+                qInfo() << iter.key() << " --> " << iter.value() << " (edit distance:" << editDistances.value(iter.key()) << ")";
+            } else {
+                qInfo() << iter.key() << " --> " << iter.value();
+            }
         }
         qInfo().nospace() << "\n"
                           << "Undetected files: " << undetectedLicenses << " (total: " << (undetectedLicenses + detectedLicenses) << ")";
     }
+    // files of documented scans must not be converted, see above
+    if (inMemoryInput || parser.isSet(spdxOption)) {
+        return 0;
+    }
 
     bool userWantsConversion {false};
     if (!(parser.isSet(dryOption) || parser.isSet(licenseConvertOption) || parser.isSet(copyrightConvertOption) || parser.isSet(forceOption))) {
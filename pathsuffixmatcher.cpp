@@ -0,0 +1,77 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "pathsuffixmatcher.h"
+#include <QFile>
+#include <QTextStream>
+
+PathSuffixMatcher::PathSuffixMatcher()
+    : mNodes(1) // root node
+{
+}
+
+int PathSuffixMatcher::child(int node, QChar character) const
+{
+    for (const auto &edge : mNodes[node].children) {
+        if (edge.first == character) {
+            return edge.second;
+        }
+    }
+    return -1;
+}
+
+void PathSuffixMatcher::addSuffix(const QString &suffix)
+{
+    // an empty suffix would match every path, which is never intended
+    if (suffix.isEmpty()) {
+        return;
+    }
+    int node = 0;
+    for (int i = suffix.length() - 1; i >= 0; --i) {
+        int next = child(node, suffix.at(i));
+        if (next < 0) {
+            next = static_cast<int>(mNodes.size());
+            mNodes[node].children.emplace_back(suffix.at(i), next);
+            mNodes.emplace_back();
+        }
+        node = next;
+    }
+    mNodes[node].terminal = true;
+}
+
+bool PathSuffixMatcher::addSuffixesFromFile(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    QTextStream in(&file);
+    QString line;
+    while (in.readLineInto(&line)) {
+        addSuffix(line.trimmed());
+    }
+    return true;
+}
+
+bool PathSuffixMatcher::matches(const QString &path) const
+{
+    int node = 0;
+    for (int i = path.length() - 1; i >= 0; --i) {
+        node = child(node, path.at(i));
+        if (node < 0) {
+            return false;
+        }
+        if (mNodes[node].terminal) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PathSuffixMatcher::isEmpty() const
+{
+    return mNodes.front().children.empty();
+}
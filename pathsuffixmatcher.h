@@ -0,0 +1,50 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef PATHSUFFIXMATCHER_H
+#define PATHSUFFIXMATCHER_H
+
+#include <QString>
+#include <vector>
+
+/**
+ * @brief Trie over reversed paths for suffix lookups
+ *
+ * All inserted suffixes are stored back-to-front, such that checking whether a path ends with
+ * any of the inserted suffixes only walks the path once from its end, independent of the number
+ * of inserted suffixes.
+ */
+class PathSuffixMatcher
+{
+public:
+    PathSuffixMatcher();
+
+    void addSuffix(const QString &suffix);
+
+    /**
+     * @brief read one suffix per line from @p fileName, empty lines are ignored
+     * @return true if the file could be read
+     */
+    bool addSuffixesFromFile(const QString &fileName);
+
+    /**
+     * @return true if @p path ends with any of the added suffixes
+     */
+    bool matches(const QString &path) const;
+
+    bool isEmpty() const;
+
+private:
+    struct Node {
+        std::vector<std::pair<QChar, int>> children;
+        bool terminal {false};
+    };
+    int child(int node, QChar character) const;
+
+    std::vector<Node> mNodes;
+};
+
+#endif
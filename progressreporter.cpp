@@ -0,0 +1,80 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "progressreporter.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <algorithm>
+#include <unistd.h>
+
+ProgressReporter::ProgressReporter(FILE *output, int intervalMilliseconds)
+    : mOutput(output)
+    , mInteractive(isatty(fileno(output)))
+    , mInterval(mInteractive ? intervalMilliseconds : 10 * intervalMilliseconds)
+{
+    mTimer.start();
+}
+
+void ProgressReporter::start(qint64 totalFiles)
+{
+    mTotalFiles = totalFiles;
+    mFiles = 0;
+    mBytes = 0;
+    mNextUpdate = mInterval;
+    mTimer.restart();
+}
+
+void ProgressReporter::addFile(const QString &filePath, qint64 bytes)
+{
+    ++mFiles;
+    mBytes += bytes;
+    qint64 nextUpdate = mNextUpdate.load(std::memory_order_relaxed);
+    const qint64 elapsed = mTimer.elapsed();
+    // only the thread that advances the update time writes the status line
+    if (elapsed >= nextUpdate && mNextUpdate.compare_exchange_strong(nextUpdate, elapsed + mInterval)) {
+        write(filePath, false);
+    }
+}
+
+void ProgressReporter::finish()
+{
+    write(QString(), true);
+}
+
+qint64 ProgressReporter::processedFiles() const
+{
+    return mFiles;
+}
+
+QString ProgressReporter::statusText(const QString &currentFile) const
+{
+    const qint64 files = mFiles;
+    const double seconds = std::max<qint64>(mTimer.elapsed(), 1) / 1000.0;
+    const double filesPerSecond = files / seconds;
+    QString text = mTotalFiles > 0 ? QStringLiteral("%1/%2 files").arg(files).arg(mTotalFiles) : QStringLiteral("%1 files").arg(files);
+    text += QStringLiteral("  %1 files/s  %2 MB/s").arg(filesPerSecond, 0, 'f', 1).arg(mBytes / seconds / (1024 * 1024), 0, 'f', 1);
+    if (mTotalFiles > 0 && files > 0 && files < mTotalFiles) {
+        const qint64 remaining = static_cast<qint64>((mTotalFiles - files) / filesPerSecond);
+        text += QStringLiteral("  ETA %1:%2").arg(remaining / 60).arg(remaining % 60, 2, 10, QLatin1Char('0'));
+    }
+    if (!currentFile.isEmpty()) {
+        text += QStringLiteral("  ") + QFileInfo(currentFile).path();
+    }
+    return text;
+}
+
+void ProgressReporter::write(const QString &currentFile, bool final)
+{
+    const QByteArray text = statusText(currentFile).toLocal8Bit();
+    QMutexLocker locker(&mOutputMutex);
+    if (mInteractive) {
+        // carriage return and clear line keep the status in a single line
+        std::fprintf(mOutput, "\r\033[K%s%s", text.constData(), final ? "\n" : "");
+    } else {
+        std::fprintf(mOutput, "%s\n", text.constData());
+    }
+    std::fflush(mOutput);
+}
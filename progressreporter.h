@@ -0,0 +1,67 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef PROGRESSREPORTER_H
+#define PROGRESSREPORTER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include <cstdio>
+
+/**
+ * @brief Throttled status line with files/s, MB/s, ETA and the current directory
+ *
+ * Processed files are counted with atomic counters, such that addFile() can be called from parallel
+ * scanning threads. The status line is written at most once per update interval, by the thread
+ * that first notices that the interval elapsed.
+ */
+class ProgressReporter
+{
+public:
+    /**
+     * @param output stream for the status line; on terminals the line is updated in place,
+     *        otherwise a new line is written with a ten times longer interval
+     * @param intervalMilliseconds minimal time between two updates of the status line
+     */
+    explicit ProgressReporter(FILE *output = stderr, int intervalMilliseconds = 250);
+
+    /**
+     * @brief reset counters and start timer
+     * @param totalFiles number of files that will be processed, 0 if unknown
+     */
+    void start(qint64 totalFiles);
+
+    void addFile(const QString &filePath, qint64 bytes);
+
+    /**
+     * @brief write final status line
+     */
+    void finish();
+
+    qint64 processedFiles() const;
+
+    /**
+     * @return status line text, without any terminal control characters
+     */
+    QString statusText(const QString &currentFile) const;
+
+private:
+    void write(const QString &currentFile, bool final);
+
+    FILE *mOutput;
+    const bool mInteractive;
+    const qint64 mInterval;
+    QElapsedTimer mTimer;
+    QMutex mOutputMutex;
+    qint64 mTotalFiles {0};
+    std::atomic<qint64> mFiles {0};
+    std::atomic<qint64> mBytes {0};
+    std::atomic<qint64> mNextUpdate {0};
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "reportmerger.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector>
+#include <algorithm>
+
+bool ReportMerger::addPartialReport(QIODevice *device)
+{
+    QVector<QPair<QString, Entry>> entries;
+    std::optional<QJsonObject> summary;
+    while (!device->atEnd()) {
+        const QByteArray line = device->readLine().trimmed();
+        if (line.isEmpty()) {
+            continue;
+        }
+        if (summary) {
+            qWarning() << "Unexpected content after summary of partial report";
+            return false;
+        }
+        QJsonParseError error;
+        const QJsonObject object = QJsonDocument::fromJson(line, &error).object();
+        if (error.error != QJsonParseError::NoError) {
+            qWarning() << "Malformed line in partial report:" << error.errorString();
+            return false;
+        }
+        if (object.contains(QLatin1String("summary"))) {
+            summary = object.value(QLatin1String("summary")).toObject();
+            continue;
+        }
+        Entry entry;
+        entry.expression = object.value(QLatin1String("expression")).toString();
+        entry.editDistance = object.value(QLatin1String("editDistance")).toInt();
+        if (object.contains(QLatin1String("mostSimilar"))) {
+            entry.suggestion = SimilarityIndex::Match {object.value(QLatin1String("mostSimilar")).toString(), object.value(QLatin1String("similarity")).toDouble()};
+        }
+        entries.append({object.value(QLatin1String("path")).toString(), entry});
+    }
+    // a missing or differing summary indicates a shard that was interrupted while writing
+    if (!summary || summary->value(QLatin1String("files")).toInt() != entries.size()) {
+        qWarning() << "Partial report is incomplete, expected summary with" << entries.size() << "files";
+        return false;
+    }
+
+    for (const auto &entry : entries) {
+        auto iter = mEntries.find(entry.first);
+        if (iter == mEntries.end()) {
+            mEntries.insert(entry.first, entry.second);
+        } else if (iter->expression != entry.second.expression) {
+            // overlapping shards with different results are treated like conflicting detections
+            qWarning() << "Conflicting results for" << entry.first << "-->" << iter->expression << entry.second.expression;
+            *iter = Entry {LicenseRegistry::AmbigiousLicense, 0, std::nullopt};
+        }
+    }
+    mElapsedMilliseconds = std::max(mElapsedMilliseconds, static_cast<qint64>(summary->value(QLatin1String("elapsedMs")).toDouble()));
+    return true;
+}
+
+void ReportMerger::write(ReportWriter &writer) const
+{
+    for (auto iter = mEntries.constBegin(); iter != mEntries.constEnd(); ++iter) {
+        writer.addFile(iter.key(), iter->expression, iter->editDistance, iter->suggestion);
+    }
+    writer.finish(mElapsedMilliseconds);
+}
+
+int ReportMerger::fileCount() const
+{
+    return mEntries.size();
+}
@@ -0,0 +1,51 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef REPORTMERGER_H
+#define REPORTMERGER_H
+
+#include "licenseregistry.h"
+#include "reportwriter.h"
+#include "similarityindex.h"
+#include <QIODevice>
+#include <QMap>
+#include <optional>
+
+/**
+ * @brief Combines NDJSON reports of sharded runs into the report of a single run
+ *
+ * Each partial report must be complete, i.e. end with its summary line. Files are written in path
+ * order, as parseAll() reports them.
+ */
+class ReportMerger
+{
+public:
+    /**
+     * @brief read one partial NDJSON report
+     * @return false if the report is malformed or truncated, in which case nothing of it is added
+     */
+    bool addPartialReport(QIODevice *device);
+
+    /**
+     * @brief write all files of all partial reports to @p writer and finish it
+     *
+     * Shards run in parallel, hence the reported scan time is the one of the slowest shard.
+     */
+    void write(ReportWriter &writer) const;
+
+    int fileCount() const;
+
+private:
+    struct Entry {
+        LicenseRegistry::SpdxExpression expression;
+        int editDistance {0};
+        std::optional<SimilarityIndex::Match> suggestion;
+    };
+    QMap<QString, Entry> mEntries;
+    qint64 mElapsedMilliseconds {0};
+};
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "reportwriter.h"
+#include <QDebug>
+#include <QStringList>
+
+std::optional<ReportWriter::Format> ReportWriter::formatFromName(const QString &name)
+{
+    if (name == QLatin1String("json")) {
+        return Format::JSON;
+    }
+    if (name == QLatin1String("csv")) {
+        return Format::CSV;
+    }
+    if (name == QLatin1String("ndjson")) {
+        return Format::NDJSON;
+    }
+    return {};
+}
+
+ReportWriter::ReportWriter(Format format, QIODevice *device)
+    : mFormat(format)
+    , mDevice(device)
+{
+    mBuffer.reserve(sFlushThreshold + 4096);
+    switch (mFormat) {
+    case Format::JSON:
+        mBuffer.append("{\n\"files\": [");
+        break;
+    case Format::CSV:
+        mBuffer.append("path,expression,edit_distance,most_similar,similarity\n");
+        break;
+    case Format::NDJSON:
+        break;
+    }
+}
+
+void ReportWriter::appendJsonString(QByteArray &buffer, const QString &text)
+{
+    QString escaped;
+    escaped.reserve(text.size() + 2);
+    escaped.append(QLatin1Char('"'));
+    for (const QChar character : text) {
+        switch (character.unicode()) {
+        case '"':
+            escaped.append(QLatin1String("\\\""));
+            break;
+        case '\\':
+            escaped.append(QLatin1String("\\\\"));
+            break;
+        case '\n':
+            escaped.append(QLatin1String("\\n"));
+            break;
+        case '\r':
+            escaped.append(QLatin1String("\\r"));
+            break;
+        case '\t':
+            escaped.append(QLatin1String("\\t"));
+            break;
+        default:
+            if (character.unicode() < 0x20) {
+                escaped.append(QStringLiteral("\\u%1").arg(character.unicode(), 4, 16, QLatin1Char('0')));
+            } else {
+                escaped.append(character);
+            }
+        }
+    }
+    escaped.append(QLatin1Char('"'));
+    buffer.append(escaped.toUtf8());
+}
+
+void ReportWriter::appendCsvField(const QString &text)
+{
+    const bool needsQuotes = text.contains(QLatin1Char(',')) || text.contains(QLatin1Char('"')) || text.contains(QLatin1Char('\n')) || text.contains(QLatin1Char('\r'));
+    if (!needsQuotes) {
+        mBuffer.append(text.toUtf8());
+        return;
+    }
+    QString quoted = text;
+    quoted.replace(QLatin1Char('"'), QLatin1String("\"\""));
+    mBuffer.append('"');
+    mBuffer.append(quoted.toUtf8());
+    mBuffer.append('"');
+}
+
+void ReportWriter::appendJsonFileEntry(const QString &path, const QString &expression, int editDistance, const std::optional<SimilarityIndex::Match> &suggestion)
+{
+    mBuffer.append("{\"path\": ");
+    appendJsonString(mBuffer, path);
+    mBuffer.append(", \"expression\": ");
+    appendJsonString(mBuffer, expression);
+    if (editDistance > 0) {
+        mBuffer.append(", \"editDistance\": ");
+        mBuffer.append(QByteArray::number(editDistance));
+    }
+    if (suggestion) {
+        mBuffer.append(", \"mostSimilar\": ");
+        appendJsonString(mBuffer, suggestion->expression);
+        mBuffer.append(", \"similarity\": ");
+        mBuffer.append(QByteArray::number(suggestion->similarity, 'f', 3));
+    }
+    mBuffer.append('}');
+}
+
+void ReportWriter::addFile(const QString &path, const LicenseRegistry::SpdxExpression &expression, int editDistance, const std::optional<SimilarityIndex::Match> &suggestion)
+{
+    switch (mFormat) {
+    case Format::JSON:
+        mBuffer.append(mFileCount == 0 ? "\n" : ",\n");
+        appendJsonFileEntry(path, expression, editDistance, suggestion);
+        break;
+    case Format::NDJSON:
+        appendJsonFileEntry(path, expression, editDistance, suggestion);
+        mBuffer.append('\n');
+        break;
+    case Format::CSV:
+        appendCsvField(path);
+        mBuffer.append(',');
+        appendCsvField(expression);
+        mBuffer.append(',');
+        if (editDistance > 0) {
+            mBuffer.append(QByteArray::number(editDistance));
+        }
+        mBuffer.append(',');
+        if (suggestion) {
+            appendCsvField(suggestion->expression);
+            mBuffer.append(',');
+            mBuffer.append(QByteArray::number(suggestion->similarity, 'f', 3));
+        } else {
+            mBuffer.append(',');
+        }
+        mBuffer.append('\n');
+        break;
+    }
+
+    ++mFileCount;
+    ++mExpressionCounts[expression];
+    if (expression == LicenseRegistry::UnknownLicense) {
+        ++mUndetectedCount;
+    }
+    flushIfNeeded();
+}
+
+void ReportWriter::appendJsonSummary(qint64 elapsedMilliseconds)
+{
+    mBuffer.append("{\"files\": ");
+    mBuffer.append(QByteArray::number(mFileCount));
+    mBuffer.append(", \"undetected\": ");
+    mBuffer.append(QByteArray::number(mUndetectedCount));
+    mBuffer.append(", \"elapsedMs\": ");
+    mBuffer.append(QByteArray::number(elapsedMilliseconds));
+    mBuffer.append(", \"expressions\": {");
+    for (auto iter = mExpressionCounts.constBegin(); iter != mExpressionCounts.constEnd(); ++iter) {
+        if (iter != mExpressionCounts.constBegin()) {
+            mBuffer.append(", ");
+        }
+        appendJsonString(mBuffer, iter.key());
+        mBuffer.append(": ");
+        mBuffer.append(QByteArray::number(iter.value()));
+    }
+    mBuffer.append("}}");
+}
+
+void ReportWriter::finish(qint64 elapsedMilliseconds)
+{
+    switch (mFormat) {
+    case Format::JSON:
+        mBuffer.append("\n],\n\"summary\": ");
+        appendJsonSummary(elapsedMilliseconds);
+        mBuffer.append("\n}\n");
+        break;
+    case Format::NDJSON:
+        mBuffer.append("{\"summary\": ");
+        appendJsonSummary(elapsedMilliseconds);
+        mBuffer.append("}\n");
+        break;
+    case Format::CSV:
+    {
+        // CSV has no place for a summary that CSV readers do not take for data rows, thus it is only logged
+        QStringList expressionCounts;
+        for (auto iter = mExpressionCounts.constBegin(); iter != mExpressionCounts.constEnd(); ++iter) {
+            expressionCounts.append(iter.key() + QLatin1String(": ") + QString::number(iter.value()));
+        }
+        qInfo().noquote() << QStringLiteral("Report summary: %1 files, %2 undetected, %3 ms; %4")
+                                 .arg(mFileCount)
+                                 .arg(mUndetectedCount)
+                                 .arg(elapsedMilliseconds)
+                                 .arg(expressionCounts.join(QLatin1String(", ")));
+        break;
+    }
+    }
+    mDevice->write(mBuffer);
+    mBuffer.clear();
+}
+
+void ReportWriter::flushIfNeeded()
+{
+    if (mBuffer.size() >= sFlushThreshold) {
+        mDevice->write(mBuffer);
+        // keeps the reserved capacity
+        mBuffer.resize(0);
+    }
+}
@@ -0,0 +1,72 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef REPORTWRITER_H
+#define REPORTWRITER_H
+
+#include "licenseregistry.h"
+#include "similarityindex.h"
+#include <QByteArray>
+#include <QIODevice>
+#include <QMap>
+#include <optional>
+
+/**
+ * @brief Buffered writer for machine-readable reports of detected licenses
+ *
+ * Results are written to the device in chunks while they are added, such that the report never has to
+ * be kept in memory. A summary with the number of files per expression, the undetected files and the
+ * scan time is written by finish(). CSV reports only contain the file rows, their summary is logged.
+ */
+class ReportWriter
+{
+public:
+    enum class Format { JSON, CSV, NDJSON };
+
+    /**
+     * @param name one of "json", "csv" or "ndjson"
+     */
+    static std::optional<Format> formatFromName(const QString &name);
+
+    ReportWriter(Format format, QIODevice *device);
+
+    /**
+     * @brief add result for one file
+     * @param editDistance token edit distance of approximate matches, not written if 0
+     * @param suggestion most similar license for files with unknown license, if any
+     */
+    void addFile(const QString &path,
+                 const LicenseRegistry::SpdxExpression &expression,
+                 int editDistance = 0,
+                 const std::optional<SimilarityIndex::Match> &suggestion = std::nullopt);
+
+    /**
+     * @brief write summary and flush all buffered output
+     * @param elapsedMilliseconds scan time that shall be reported
+     */
+    void finish(qint64 elapsedMilliseconds);
+
+    /**
+     * @brief append @p text as quoted and escaped UTF-8 JSON string to @p buffer
+     */
+    static void appendJsonString(QByteArray &buffer, const QString &text);
+
+private:
+    void appendCsvField(const QString &text);
+    void appendJsonFileEntry(const QString &path, const QString &expression, int editDistance, const std::optional<SimilarityIndex::Match> &suggestion);
+    void appendJsonSummary(qint64 elapsedMilliseconds);
+    void flushIfNeeded();
+
+    static constexpr int sFlushThreshold = 64 * 1024;
+    Format mFormat;
+    QIODevice *mDevice;
+    QByteArray mBuffer;
+    QMap<LicenseRegistry::SpdxExpression, int> mExpressionCounts;
+    int mFileCount {0};
+    int mUndetectedCount {0};
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "similarityindex.h"
+#include "licensetokenizer.h"
+#include <algorithm>
+#include <limits>
+
+namespace
+{
+// splitmix64 step, used for deterministic seeds and as finalizer of shingle hashes
+quint64 mix(quint64 value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+}
+
+SimilarityIndex::SimilarityIndex()
+{
+    // fixed seeds keep signatures comparable between runs
+    quint64 seed = 0x4C6963656E736544ULL;
+    for (int i = 0; i < sSignatureSize; ++i) {
+        seed = mix(seed);
+        mMultipliers[i] = seed | 1; // odd multipliers for multiply-shift hashing
+        seed = mix(seed);
+        mIncrements[i] = seed;
+    }
+}
+
+bool SimilarityIndex::computeSignature(QStringView text, Signature &signature) const
+{
+    thread_local std::vector<LicenseTokenizer::Token> tokens;
+    thread_local std::vector<quint64> tokenHashes;
+    LicenseTokenizer::tokenize(text, tokens, sMaxTokens);
+    if (tokens.size() < static_cast<std::size_t>(sShingleSize)) {
+        return false;
+    }
+    tokenHashes.resize(tokens.size());
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        tokenHashes[i] = LicenseTokenizer::tokenHash(text.mid(tokens[i].start, tokens[i].end - tokens[i].start));
+    }
+
+    signature.fill(std::numeric_limits<quint32>::max());
+    for (std::size_t i = 0; i + sShingleSize <= tokenHashes.size(); ++i) {
+        quint64 shingle = 0;
+        for (int j = 0; j < sShingleSize; ++j) {
+            shingle = mix(shingle ^ tokenHashes[i + j]);
+        }
+        for (int k = 0; k < sSignatureSize; ++k) {
+            const auto value = static_cast<quint32>((mMultipliers[k] * shingle + mIncrements[k]) >> 32);
+            signature[k] = std::min(signature[k], value);
+        }
+    }
+    return true;
+}
+
+quint64 SimilarityIndex::bandHash(const Signature &signature, int band)
+{
+    quint64 hash = static_cast<quint64>(band);
+    for (int row = 0; row < sRows; ++row) {
+        hash = mix(hash ^ signature[band * sRows + row]);
+    }
+    return hash;
+}
+
+void SimilarityIndex::addTemplate(const QString &expression, const QString &text)
+{
+    Signature signature;
+    if (!computeSignature(text, signature)) {
+        return;
+    }
+    const int index = static_cast<int>(mTemplates.size());
+    mTemplates.emplace_back(expression, signature);
+    for (int band = 0; band < sBands; ++band) {
+        mBuckets[band][bandHash(signature, band)].push_back(index);
+    }
+}
+
+std::optional<SimilarityIndex::Match> SimilarityIndex::findNearest(QStringView text) const
+{
+    Signature signature;
+    if (!computeSignature(text, signature)) {
+        return {};
+    }
+
+    int bestIndex = -1;
+    int bestAgreement = 0;
+    for (int band = 0; band < sBands; ++band) {
+        const auto bucket = mBuckets[band].constFind(bandHash(signature, band));
+        if (bucket == mBuckets[band].constEnd()) {
+            continue;
+        }
+        for (int index : bucket.value()) {
+            const Signature &candidate = mTemplates[index].second;
+            int agreement = 0;
+            for (int k = 0; k < sSignatureSize; ++k) {
+                agreement += candidate[k] == signature[k] ? 1 : 0;
+            }
+            if (agreement > bestAgreement || (agreement == bestAgreement && index < bestIndex)) {
+                bestAgreement = agreement;
+                bestIndex = index;
+            }
+        }
+    }
+    if (bestIndex < 0) {
+        return {};
+    }
+    return Match {mTemplates[bestIndex].first, static_cast<double>(bestAgreement) / sSignatureSize};
+}
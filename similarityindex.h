@@ -0,0 +1,63 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef SIMILARITYINDEX_H
+#define SIMILARITYINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QStringView>
+#include <array>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief MinHash based similarity index of license header templates
+ *
+ * Every text is represented by the set of its shingles, which are sequences of three consecutive
+ * normalized tokens (see LicenseTokenizer). The MinHash signature of this set allows to estimate the
+ * Jaccard similarity of two texts, and locality sensitive hashing of signature bands selects the
+ * candidate templates for a query without comparing it to all templates.
+ *
+ * This index is only meant to give hints for texts with unknown licenses, it never replaces
+ * the exact detection.
+ */
+class SimilarityIndex
+{
+public:
+    struct Match {
+        QString expression;
+        double similarity; //!< estimated Jaccard similarity in [0, 1]
+    };
+
+    SimilarityIndex();
+
+    void addTemplate(const QString &expression, const QString &text);
+
+    /**
+     * @brief find template that is most similar to @p text
+     * @return expression and similarity of best candidate, if any candidate was found
+     */
+    std::optional<Match> findNearest(QStringView text) const;
+
+private:
+    static constexpr int sBands = 16;
+    static constexpr int sRows = 4;
+    static constexpr int sSignatureSize = sBands * sRows;
+    static constexpr int sShingleSize = 3;
+    static constexpr int sMaxTokens = 2000;
+    using Signature = std::array<quint32, sSignatureSize>;
+
+    bool computeSignature(QStringView text, Signature &signature) const;
+    static quint64 bandHash(const Signature &signature, int band);
+
+    std::array<quint64, sSignatureSize> mMultipliers;
+    std::array<quint64, sSignatureSize> mIncrements;
+    std::vector<std::pair<QString, Signature>> mTemplates;
+    std::array<QHash<quint64, std::vector<int>>, sBands> mBuckets;
+};
+
+#endif
@@ -0,0 +1,211 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "skipcharpruner.h"
+#include <cstdint>
+#include <cstring>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define SKIPCHARPRUNER_SSE2 1
+#define SKIPCHARPRUNER_AVX2 1
+#define SKIPCHARPRUNER_TARGET(name) __attribute__((target(name)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64))
+#include <emmintrin.h>
+#define SKIPCHARPRUNER_SSE2 1
+#define SKIPCHARPRUNER_TARGET(name)
+#endif
+
+namespace
+{
+struct PruneState {
+    char16_t *output;
+    SkipCharPruner::SkipRuns &skipRuns;
+    int prunedLength {0};
+    int skipped {0};
+    bool inSkipRun {false};
+
+    inline void skip(int count)
+    {
+        skipped += count;
+        inSkipRun = true;
+    }
+    inline void closeSkipRun()
+    {
+        if (inSkipRun) {
+            skipRuns.emplace_back(prunedLength, skipped);
+            inSkipRun = false;
+        }
+    }
+};
+
+inline void pruneScalarRange(const char16_t *input, int begin, int end, PruneState &state)
+{
+    for (int i = begin; i < end; ++i) {
+        if (SkipCharPruner::isSkipChar(input[i])) {
+            state.skip(1);
+        } else {
+            state.closeSkipRun();
+            state.output[state.prunedLength++] = input[i];
+        }
+    }
+}
+
+/**
+ * Compacts one block of @p blockSize characters, for which bit i of @p mask is set if character i
+ * is a skip character. Blocks without or with only skip characters are handled without looking
+ * at the single characters.
+ */
+inline void pruneBlock(const char16_t *input, int blockSize, std::uint32_t mask, std::uint32_t fullMask, PruneState &state)
+{
+    if (mask == 0) {
+        state.closeSkipRun();
+        std::memcpy(state.output + state.prunedLength, input, blockSize * sizeof(char16_t));
+        state.prunedLength += blockSize;
+    } else if (mask == fullMask) {
+        state.skip(blockSize);
+    } else {
+        for (int i = 0; i < blockSize; ++i) {
+            if (mask & (std::uint32_t(1) << i)) {
+                state.skip(1);
+            } else {
+                state.closeSkipRun();
+                state.output[state.prunedLength++] = input[i];
+            }
+        }
+    }
+}
+
+int pruneScalar(const char16_t *input, int length, PruneState &state)
+{
+    pruneScalarRange(input, 0, length, state);
+    return state.prunedLength;
+}
+
+#if defined(SKIPCHARPRUNER_SSE2)
+SKIPCHARPRUNER_TARGET("sse2") inline __m128i classifySse2(__m128i characters)
+{
+    __m128i result = _mm_cmpeq_epi16(characters, _mm_set1_epi16(' '));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(characters, _mm_set1_epi16('\n')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(characters, _mm_set1_epi16('\t')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(characters, _mm_set1_epi16('/')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(characters, _mm_set1_epi16('-')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(characters, _mm_set1_epi16('*')));
+    result = _mm_or_si128(result, _mm_cmpeq_epi16(characters, _mm_set1_epi16('#')));
+    return result;
+}
+
+SKIPCHARPRUNER_TARGET("sse2") int pruneSse2(const char16_t *input, int length, PruneState &state)
+{
+    int i = 0;
+    for (; i + 16 <= length; i += 16) {
+        const __m128i low = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+        const __m128i high = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i + 8));
+        // saturating pack turns every 16 bit lane compare result into one byte
+        const __m128i packed = _mm_packs_epi16(classifySse2(low), classifySse2(high));
+        const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(packed));
+        pruneBlock(input + i, 16, mask, 0xFFFFu, state);
+    }
+    pruneScalarRange(input, i, length, state);
+    return state.prunedLength;
+}
+#endif
+
+#if defined(SKIPCHARPRUNER_AVX2)
+SKIPCHARPRUNER_TARGET("avx2") inline __m256i classifyAvx2(__m256i characters)
+{
+    __m256i result = _mm256_cmpeq_epi16(characters, _mm256_set1_epi16(' '));
+    result = _mm256_or_si256(result, _mm256_cmpeq_epi16(characters, _mm256_set1_epi16('\n')));
+    result = _mm256_or_si256(result, _mm256_cmpeq_epi16(characters, _mm256_set1_epi16('\t')));
+    result = _mm256_or_si256(result, _mm256_cmpeq_epi16(characters, _mm256_set1_epi16('/')));
+    result = _mm256_or_si256(result, _mm256_cmpeq_epi16(characters, _mm256_set1_epi16('-')));
+    result = _mm256_or_si256(result, _mm256_cmpeq_epi16(characters, _mm256_set1_epi16('*')));
+    result = _mm256_or_si256(result, _mm256_cmpeq_epi16(characters, _mm256_set1_epi16('#')));
+    return result;
+}
+
+SKIPCHARPRUNER_TARGET("avx2") int pruneAvx2(const char16_t *input, int length, PruneState &state)
+{
+    int i = 0;
+    for (; i + 32 <= length; i += 32) {
+        const __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i));
+        const __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + i + 16));
+        // pack works per 128 bit lane, the permutation restores the character order
+        __m256i packed = _mm256_packs_epi16(classifyAvx2(low), classifyAvx2(high));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(packed));
+        pruneBlock(input + i, 32, mask, 0xFFFFFFFFu, state);
+    }
+    pruneScalarRange(input, i, length, state);
+    return state.prunedLength;
+}
+#endif
+}
+
+SkipCharPruner::SkipCharPruner(Implementation implementation)
+    : mImplementation(isSupported(implementation) ? implementation : Implementation::Scalar)
+{
+}
+
+SkipCharPruner::Implementation SkipCharPruner::bestImplementation()
+{
+    if (isSupported(Implementation::AVX2)) {
+        return Implementation::AVX2;
+    }
+    if (isSupported(Implementation::SSE2)) {
+        return Implementation::SSE2;
+    }
+    return Implementation::Scalar;
+}
+
+bool SkipCharPruner::isSupported(Implementation implementation)
+{
+    switch (implementation) {
+    case Implementation::Scalar:
+        return true;
+    case Implementation::SSE2:
+#if defined(SKIPCHARPRUNER_SSE2) && defined(__GNUC__)
+        return __builtin_cpu_supports("sse2");
+#elif defined(SKIPCHARPRUNER_SSE2)
+        return true; // part of the x86-64 baseline
+#else
+        return false;
+#endif
+    case Implementation::AVX2:
+#if defined(SKIPCHARPRUNER_AVX2)
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+SkipCharPruner::Implementation SkipCharPruner::implementation() const
+{
+    return mImplementation;
+}
+
+int SkipCharPruner::prune(const QChar *input, int length, QChar *output, SkipRuns &skipRuns) const
+{
+    skipRuns.clear();
+    // QChar is a plain wrapper of one UTF-16 code unit
+    const auto *in = reinterpret_cast<const char16_t *>(input);
+    PruneState state {reinterpret_cast<char16_t *>(output), skipRuns};
+
+    switch (mImplementation) {
+#if defined(SKIPCHARPRUNER_AVX2)
+    case Implementation::AVX2:
+        return pruneAvx2(in, length, state);
+#endif
+#if defined(SKIPCHARPRUNER_SSE2)
+    case Implementation::SSE2:
+        return pruneSse2(in, length, state);
+#endif
+    default:
+        return pruneScalar(in, length, state);
+    }
+}
@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef SKIPCHARPRUNER_H
+#define SKIPCHARPRUNER_H
+
+#include <QChar>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Removes skip characters from UTF-16 text
+ *
+ * The skip characters are [ \n\t/-*#]. Besides the scalar implementation there are vectorized
+ * implementations for x86 that classify 16 (SSE2) or 32 (AVX2) code units at once. The best
+ * implementation supported by the CPU is selected at runtime.
+ */
+class SkipCharPruner
+{
+public:
+    enum class Implementation { Scalar, SSE2, AVX2 };
+    using SkipRuns = std::vector<std::pair<int, int>>;
+
+    explicit SkipCharPruner(Implementation implementation = bestImplementation());
+
+    static Implementation bestImplementation();
+    static bool isSupported(Implementation implementation);
+
+    Implementation implementation() const;
+
+    static constexpr bool isSkipChar(char16_t character)
+    {
+        switch (character) {
+        case u' ':
+        case u'\n':
+        case u'\t':
+        case u'/':
+        case u'-':
+        case u'*':
+        case u'#':
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    /**
+     * @brief copy all non-skip characters of @p input to @p output
+     * @param input text of @p length characters
+     * @param output buffer of at least @p length characters
+     * @param skipRuns is cleared and filled with one pair for every run of skip characters that is
+     *        followed by a non-skip character: the pruned position following the run and the total
+     *        number of skip characters before that position
+     * @return number of characters written to @p output
+     */
+    int prune(const QChar *input, int length, QChar *output, SkipRuns &skipRuns) const;
+
+private:
+    Implementation mImplementation;
+};
+
+#endif
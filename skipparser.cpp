@@ -5,35 +5,19 @@
  */
 
 #include "skipparser.h"
+#include "skipcharpruner.h"
 #include <QDebug>
+#include <algorithm>
 #include <functional>
 #include <optional>
 #include <set>
 
 // for performance reasons, we need to have to lists
-// but they must be kept in sync
+// but they must be kept in sync with SkipCharPruner::isSkipChar()
 const QRegularExpression SkipParser::sSkipCharDetection("[ |\\\n|\\\t|/|\\-|\\*|#]");
 constexpr bool isSkipChar(const QChar &character)
 {
-    switch (character.toLatin1()) {
-    case ' ':
-        return true;
-    case '\n':
-        return true;
-    case '\t':
-        return true;
-    case '/':
-        return true;
-    case '-':
-        return true;
-    case '*':
-        return true;
-    case '#':
-        return true;
-    default:
-        return false;
-    }
-    return false;
+    return SkipCharPruner::isSkipChar(character.unicode());
 }
 
 std::optional<std::pair<int, int>> SkipParser::findMatchNaive(QString text, QString pattern) const
@@ -94,16 +78,26 @@ std::vector<int> SkipParser::computeKmpPrefix(const QString &pattern) const
     return prefix;
 }
 
-std::optional<std::pair<int, int>> SkipParser::findMatchKMP(std::vector<QChar> prunedText, std::vector<int> textSkipPrefix, QString pattern) const
+int SkipParser::originalPosition(const std::vector<std::pair<int, int>> &skipRuns, int prunedPosition)
+{
+    // find last run that starts at or before the pruned position
+    auto run = std::upper_bound(skipRuns.cbegin(), skipRuns.cend(), prunedPosition, [](int position, const std::pair<int, int> &marker) {
+        return position < marker.first;
+    });
+    if (run == skipRuns.cbegin()) {
+        return prunedPosition;
+    }
+    return prunedPosition + std::prev(run)->second;
+}
+
+std::optional<std::pair<int, int>> SkipParser::findMatchKMP(const QString &prunedText, const std::vector<std::pair<int, int>> &skipRuns, const QString &pattern) const
 {
     // obtain prefix
-    std::vector<int> prefix;
-    if (mPrefixCache.contains(pattern)) {
-        prefix = mPrefixCache[pattern];
-    } else {
-        prefix = computeKmpPrefix(pattern);
-        mPrefixCache.insert(pattern, prefix);
+    auto prefixIter = mPrefixCache.constFind(pattern);
+    if (prefixIter == mPrefixCache.constEnd()) {
+        prefixIter = mPrefixCache.insert(pattern, computeKmpPrefix(pattern));
     }
+    const std::vector<int> &prefix = prefixIter.value();
 
     // KMP Matcher
     const int textLength = prunedText.size();
@@ -116,17 +110,18 @@ std::optional<std::pair<int, int>> SkipParser::findMatchKMP(std::vector<QChar> p
             q = q + 1;
         }
         if (q == pattern.length()) {
-            return std::optional<std::pair<int, int>> {{i - q + textSkipPrefix.at(i - q), i - 1 + textSkipPrefix.at(i - 1)}};
+            // offsets in the original text are only recovered for the match
+            return std::optional<std::pair<int, int>> {{originalPosition(skipRuns, i - q), originalPosition(skipRuns, i - 1)}};
         }
     }
 
     return {};
 }
 
-std::optional<std::pair<int, int>> SkipParser::findMatch(QString text, QString pattern) const
+std::optional<std::pair<int, int>> SkipParser::findMatch(const QString &text, const QString &pattern) const
 {
-    auto textPreprocessing = computeTextSkipPrefix(text);
-    auto match = findMatchKMP(textPreprocessing.first, textPreprocessing.second, pattern.remove(sSkipCharDetection));
+    computeTextSkipRuns(text);
+    auto match = findMatchKMP(mPrunedText, mSkipRuns, prunedPattern(pattern));
     qDebug() << "text   :" << text;
     qDebug() << "pattern:" << pattern;
     //            qDebug() << "start:  " << start;
@@ -134,42 +129,42 @@ std::optional<std::pair<int, int>> SkipParser::findMatch(QString text, QString p
     return match;
 }
 
-std::pair<std::vector<QChar>, std::vector<int>> SkipParser::computeTextSkipPrefix(const QString &text) const
+void SkipParser::computeTextSkipRuns(const QString &text) const
 {
-    // prune text and compute skip prefix
-    // skip prefix notes number of skipped chars for each position in "text"
-    std::vector<int> textSkipPrefix(text.size());
-    std::vector<QChar> prunedText;
-    prunedText.reserve(text.size());
-    int skipped = 0;
-    for (int i = 0; i < text.size(); ++i) {
-        if (isSkipChar(text.at(i))) {
-            textSkipPrefix.at(i - skipped) = skipped;
-            ++skipped;
-        } else {
-            prunedText.push_back(text.at(i));
-            textSkipPrefix.at(i - skipped) = skipped;
-        }
-    }
-    prunedText.shrink_to_fit();
-    return {prunedText, textSkipPrefix};
+    // prune text and note skip runs, such that positions in the pruned text can be mapped back
+    // resizing keeps the capacity of both buffers
+    static const SkipCharPruner pruner;
+    mPrunedText.resize(text.size());
+    const int prunedLength = pruner.prune(text.constData(), text.size(), mPrunedText.data(), mSkipRuns);
+    mPrunedText.resize(prunedLength);
 }
 
-std::optional<std::pair<int, int>> SkipParser::findMatch(QString text, QVector<QString> patterns) const
+const QString &SkipParser::prunedPattern(const QString &pattern) const
 {
-    // KMP can work with pruned patterns
-    QSet<QString> prunedPatterns;
-    // prune all skip chars from pattern
-    for (const auto &pattern : patterns) {
+    auto iter = mPrunedPatternCache.constFind(pattern);
+    if (iter == mPrunedPatternCache.constEnd()) {
         QString tmpPattern = pattern;
         tmpPattern.remove(sSkipCharDetection);
-        prunedPatterns.insert(tmpPattern);
+        iter = mPrunedPatternCache.insert(pattern, tmpPattern);
     }
-    //    qDebug() << "Pruned canonical texts:" << (patterns.count() - prunedPatterns.count());
+    return iter.value();
+}
 
-    auto textPreprocessing = computeTextSkipPrefix(text);
-    for (const auto &pattern : prunedPatterns) {
-        if (auto match = findMatchKMP(textPreprocessing.first, textPreprocessing.second, pattern)) {
+std::optional<std::pair<int, int>> SkipParser::findMatch(const QString &text, const QVector<QString> &patterns, int *matchedPatternIndex) const
+{
+    computeTextSkipRuns(text);
+    // KMP can work with pruned patterns, patterns that are equal after pruning are only tried once
+    QSet<QString> triedPatterns;
+    for (int i = 0; i < patterns.size(); ++i) {
+        const QString &pattern = prunedPattern(patterns.at(i));
+        if (triedPatterns.contains(pattern)) {
+            continue;
+        }
+        triedPatterns.insert(pattern);
+        if (auto match = findMatchKMP(mPrunedText, mSkipRuns, pattern)) {
+            if (matchedPatternIndex) {
+                *matchedPatternIndex = i;
+            }
             return match;
         }
     }
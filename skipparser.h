@@ -16,15 +16,16 @@
 class SkipParser
 {
 public:
-    std::optional<std::pair<int, int>> findMatch(QString text, QString pattern) const;
+    std::optional<std::pair<int, int>> findMatch(const QString &text, const QString &pattern) const;
 
     /**
      * @brief obtiain first matching pattern position
      * @param text
      * @param pattern
+     * @param matchedPatternIndex if not null, set to the index of the matching pattern
      * @return position, if found
      */
-    std::optional<std::pair<int, int>> findMatch(QString text, QVector<QString> pattern) const;
+    std::optional<std::pair<int, int>> findMatch(const QString &text, const QVector<QString> &pattern, int *matchedPatternIndex = nullptr) const;
 
 private:
     /**
@@ -34,12 +35,32 @@ private:
      */
     std::vector<int> computeKmpPrefix(const QString &prunedPattern) const;
 
-    std::pair<std::vector<QChar>, std::vector<int>> computeTextSkipPrefix(const QString &text) const;
+    /**
+     * @brief prune @p text into mPrunedText and compute the skip runs into mSkipRuns
+     *
+     * Both buffers are reused between calls to avoid allocations per processed text.
+     */
+    void computeTextSkipRuns(const QString &text) const;
+
+    /**
+     * @brief map position in pruned text back to position in original text
+     * @param skipRuns sparse skip-run markers as computed by computeTextSkipRuns()
+     */
+    static int originalPosition(const std::vector<std::pair<int, int>> &skipRuns, int prunedPosition);
+
+    const QString &prunedPattern(const QString &pattern) const;
 
-    std::optional<std::pair<int, int>> findMatchKMP(std::vector<QChar> prunedText, std::vector<int> textSkipPrefix, QString pattern) const;
+    std::optional<std::pair<int, int>> findMatchKMP(const QString &prunedText, const std::vector<std::pair<int, int>> &skipRuns, const QString &pattern) const;
     std::optional<std::pair<int, int>> findMatchNaive(QString text, QString pattern) const;
     static const QRegularExpression sSkipCharDetection;
     mutable QHash<QString, std::vector<int>> mPrefixCache;
+    mutable QHash<QString, QString> mPrunedPatternCache;
+    mutable QString mPrunedText;
+    /**
+     * sparse skip-run markers: for every run of skipped chars one pair of the pruned position
+     * following the run and the total number of skipped chars before that position
+     */
+    mutable std::vector<std::pair<int, int>> mSkipRuns;
 };
 
 #endif
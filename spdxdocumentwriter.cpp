@@ -0,0 +1,212 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "spdxdocumentwriter.h"
+#include "reportwriter.h"
+#include <QDateTime>
+#include <QFile>
+#include <QUuid>
+
+namespace
+{
+const QLatin1String sLicenseRefPrefix("LicenseRef-");
+
+// tag-value has no escape mechanism for multi-line texts, thus closing tags within the text are broken up
+QByteArray tagValueText(const QString &text)
+{
+    return "<text>" + QString(text).replace(QLatin1String("</text>"), QLatin1String("&lt;/text&gt;")).toUtf8() + "</text>";
+}
+}
+
+SpdxDocumentWriter::Format SpdxDocumentWriter::formatFromFileName(const QString &fileName)
+{
+    return fileName.endsWith(QLatin1String(".json"), Qt::CaseInsensitive) ? Format::JSON : Format::TAG_VALUE;
+}
+
+QStringList SpdxDocumentWriter::licenseInfoInFile(const LicenseRegistry::SpdxExpression &expression)
+{
+    if (expression == LicenseRegistry::MissingLicense || expression == LicenseRegistry::MissingLicenseForGeneratedFile) {
+        return {QStringLiteral("NONE")};
+    }
+    if (expression.isEmpty() || expression == LicenseRegistry::UnknownLicense || expression == LicenseRegistry::AmbigiousLicense
+        || expression == LicenseRegistry::ToClarifyLicense) {
+        return {QStringLiteral("NOASSERTION")};
+    }
+
+    // expressions use "_" instead of spaces, see license template directory names
+    QStringList identifiers;
+    const QStringList terms = QString(expression).replace(QLatin1String("_AND_"), QLatin1String("_OR_")).split(QLatin1String("_OR_"));
+    for (const QString &term : terms) {
+        // LicenseInfoInFile only lists licenses, exceptions are part of the concluded expression
+        const QString identifier = term.section(QLatin1String("_WITH_"), 0, 0);
+        if (!identifier.isEmpty() && !identifiers.contains(identifier)) {
+            identifiers.append(identifier);
+        }
+    }
+    return identifiers;
+}
+
+SpdxDocumentWriter::SpdxDocumentWriter(Format format, QIODevice *device, const QString &documentName)
+    : mFormat(format)
+    , mDevice(device)
+{
+    mBuffer.reserve(sFlushThreshold + 4096);
+    const QString documentNamespace = QStringLiteral("https://spdx.org/spdxdocs/%1-%2").arg(documentName, QUuid::createUuid().toString(QUuid::WithoutBraces));
+    const QString created = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    switch (mFormat) {
+    case Format::TAG_VALUE:
+        mBuffer.append("SPDXVersion: SPDX-2.3\n");
+        mBuffer.append("DataLicense: CC0-1.0\n");
+        mBuffer.append("SPDXID: SPDXRef-DOCUMENT\n");
+        mBuffer.append("DocumentName: " + documentName.toUtf8() + '\n');
+        mBuffer.append("DocumentNamespace: " + documentNamespace.toUtf8() + '\n');
+        mBuffer.append("Creator: Tool: licensedigger\n");
+        mBuffer.append("Created: " + created.toUtf8() + '\n');
+        break;
+    case Format::JSON:
+        mBuffer.append("{\n\"spdxVersion\": \"SPDX-2.3\",\n\"dataLicense\": \"CC0-1.0\",\n\"SPDXID\": \"SPDXRef-DOCUMENT\",\n\"name\": ");
+        ReportWriter::appendJsonString(mBuffer, documentName);
+        mBuffer.append(",\n\"documentNamespace\": ");
+        ReportWriter::appendJsonString(mBuffer, documentNamespace);
+        mBuffer.append(",\n\"creationInfo\": {\"creators\": [\"Tool: licensedigger\"], \"created\": ");
+        ReportWriter::appendJsonString(mBuffer, created);
+        mBuffer.append("},\n\"files\": [");
+        break;
+    }
+}
+
+void SpdxDocumentWriter::appendTagValueFile(const QString &spdxId, const QString &path, const QStringList &licenses, const QByteArray &sha1, const QString &copyrightText)
+{
+    mBuffer.append("\nFileName: ./" + path.toUtf8() + '\n');
+    mBuffer.append("SPDXID: " + spdxId.toUtf8() + '\n');
+    mBuffer.append("FileChecksum: SHA1: " + sha1.toHex() + '\n');
+    mBuffer.append("LicenseConcluded: NOASSERTION\n");
+    for (const QString &license : licenses) {
+        mBuffer.append("LicenseInfoInFile: " + license.toUtf8() + '\n');
+    }
+    if (copyrightText == QLatin1String("NONE")) {
+        mBuffer.append("FileCopyrightText: NONE\n");
+    } else {
+        mBuffer.append("FileCopyrightText: " + tagValueText(copyrightText) + '\n');
+    }
+}
+
+void SpdxDocumentWriter::appendJsonFile(const QString &spdxId, const QString &path, const QStringList &licenses, const QByteArray &sha1, const QString &copyrightText)
+{
+    mBuffer.append("{\"fileName\": ");
+    ReportWriter::appendJsonString(mBuffer, QLatin1String("./") + path);
+    mBuffer.append(", \"SPDXID\": ");
+    ReportWriter::appendJsonString(mBuffer, spdxId);
+    mBuffer.append(", \"checksums\": [{\"algorithm\": \"SHA1\", \"checksumValue\": \"" + sha1.toHex() + "\"}]");
+    mBuffer.append(", \"licenseConcluded\": \"NOASSERTION\", \"licenseInfoInFiles\": [");
+    for (int i = 0; i < licenses.size(); ++i) {
+        if (i > 0) {
+            mBuffer.append(", ");
+        }
+        ReportWriter::appendJsonString(mBuffer, licenses.at(i));
+    }
+    mBuffer.append("], \"copyrightText\": ");
+    ReportWriter::appendJsonString(mBuffer, copyrightText);
+    mBuffer.append('}');
+}
+
+void SpdxDocumentWriter::addFile(const QString &path, const LicenseRegistry::SpdxExpression &expression, const QByteArray &sha1, const QStringList &copyrights)
+{
+    ++mFileCount;
+    const QString spdxId = QStringLiteral("SPDXRef-File-%1").arg(mFileCount);
+    const QStringList licenses = licenseInfoInFile(expression);
+    for (const QString &license : licenses) {
+        if (license.startsWith(sLicenseRefPrefix) && !mLicenseRefs.contains(license)) {
+            mLicenseRefs.append(license);
+        }
+    }
+    const QString copyrightText = copyrights.isEmpty() ? QStringLiteral("NONE") : copyrights.join(QLatin1Char('\n'));
+    switch (mFormat) {
+    case Format::TAG_VALUE:
+        appendTagValueFile(spdxId, path, licenses, sha1, copyrightText);
+        break;
+    case Format::JSON:
+        mBuffer.append(mFileCount == 1 ? "\n" : ",\n");
+        appendJsonFile(spdxId, path, licenses, sha1, copyrightText);
+        break;
+    }
+    flushIfNeeded();
+}
+
+void SpdxDocumentWriter::appendExtractedLicensingInfos()
+{
+    // texts of license references are part of the registry resources
+    QMap<LicenseRegistry::SpdxIdentifier, QString> licenseFiles;
+    if (!mLicenseRefs.isEmpty()) {
+        licenseFiles = LicenseRegistry().licenseFiles();
+    }
+    for (int i = 0; i < mLicenseRefs.size(); ++i) {
+        const QString &licenseRef = mLicenseRefs.at(i);
+        QString text;
+        QFile file(licenseFiles.value(licenseRef));
+        if (file.open(QIODevice::ReadOnly)) {
+            text = QString::fromUtf8(file.readAll());
+        } else {
+            text = QStringLiteral("The license text of %1 is not available.").arg(licenseRef);
+        }
+        const QString name = licenseRef.mid(sLicenseRefPrefix.size());
+        switch (mFormat) {
+        case Format::TAG_VALUE:
+            mBuffer.append("\nLicenseID: " + licenseRef.toUtf8() + '\n');
+            mBuffer.append("ExtractedText: " + tagValueText(text) + '\n');
+            mBuffer.append("LicenseName: " + name.toUtf8() + '\n');
+            break;
+        case Format::JSON:
+            mBuffer.append(i == 0 ? "\n" : ",\n");
+            mBuffer.append("{\"licenseId\": ");
+            ReportWriter::appendJsonString(mBuffer, licenseRef);
+            mBuffer.append(", \"extractedText\": ");
+            ReportWriter::appendJsonString(mBuffer, text);
+            mBuffer.append(", \"name\": ");
+            ReportWriter::appendJsonString(mBuffer, name);
+            mBuffer.append('}');
+            break;
+        }
+        flushIfNeeded();
+    }
+}
+
+void SpdxDocumentWriter::finish()
+{
+    // file ids are consecutive, hence relationships do not need any per-file state
+    switch (mFormat) {
+    case Format::TAG_VALUE:
+        appendExtractedLicensingInfos();
+        mBuffer.append('\n');
+        for (int i = 1; i <= mFileCount; ++i) {
+            mBuffer.append("Relationship: SPDXRef-DOCUMENT DESCRIBES SPDXRef-File-" + QByteArray::number(i) + '\n');
+            flushIfNeeded();
+        }
+        break;
+    case Format::JSON:
+        mBuffer.append("\n],\n\"hasExtractedLicensingInfos\": [");
+        appendExtractedLicensingInfos();
+        mBuffer.append("\n],\n\"relationships\": [");
+        for (int i = 1; i <= mFileCount; ++i) {
+            mBuffer.append(i == 1 ? "\n" : ",\n");
+            mBuffer.append("{\"spdxElementId\": \"SPDXRef-DOCUMENT\", \"relationshipType\": \"DESCRIBES\", \"relatedSpdxElement\": \"SPDXRef-File-" + QByteArray::number(i) + "\"}");
+            flushIfNeeded();
+        }
+        mBuffer.append("\n]\n}\n");
+        break;
+    }
+    mDevice->write(mBuffer);
+    mBuffer.clear();
+}
+
+void SpdxDocumentWriter::flushIfNeeded()
+{
+    if (mBuffer.size() >= sFlushThreshold) {
+        mDevice->write(mBuffer);
+        // keeps the reserved capacity
+        mBuffer.resize(0);
+    }
+}
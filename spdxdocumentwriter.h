@@ -0,0 +1,73 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef SPDXDOCUMENTWRITER_H
+#define SPDXDOCUMENTWRITER_H
+
+#include "licenseregistry.h"
+#include <QByteArray>
+#include <QIODevice>
+#include <QStringList>
+#include <optional>
+
+/**
+ * @brief Buffered writer for SPDX 2.3 documents in tag-value or JSON format
+ *
+ * Every file is described by its checksum, the license identifiers found in it and its copyright
+ * statements. File entries are written to the device in chunks while they are added, such that the
+ * document never has to be kept in memory. Texts of all used LicenseRef-* licenses are added as
+ * extracted licensing information by finish().
+ */
+class SpdxDocumentWriter
+{
+public:
+    enum class Format { TAG_VALUE, JSON };
+
+    /**
+     * @brief JSON for file names ending with ".json", tag-value otherwise
+     */
+    static Format formatFromFileName(const QString &fileName);
+
+    /**
+     * @brief list of license identifiers for LicenseInfoInFile
+     *
+     * Compound expressions are split into their license terms and exceptions. Non-license markers
+     * are mapped to NOASSERTION or NONE.
+     */
+    static QStringList licenseInfoInFile(const LicenseRegistry::SpdxExpression &expression);
+
+    /**
+     * @param documentName name of the document, also used for the document namespace
+     */
+    SpdxDocumentWriter(Format format, QIODevice *device, const QString &documentName);
+
+    /**
+     * @param path file path relative to the document root
+     * @param sha1 SHA1 checksum of the raw file content
+     * @param copyrights copyright statements of the file
+     */
+    void addFile(const QString &path, const LicenseRegistry::SpdxExpression &expression, const QByteArray &sha1, const QStringList &copyrights);
+
+    /**
+     * @brief write extracted license texts and document relationships, and flush all buffered output
+     */
+    void finish();
+
+private:
+    void appendTagValueFile(const QString &spdxId, const QString &path, const QStringList &licenses, const QByteArray &sha1, const QString &copyrightText);
+    void appendJsonFile(const QString &spdxId, const QString &path, const QStringList &licenses, const QByteArray &sha1, const QString &copyrightText);
+    void appendExtractedLicensingInfos();
+    void flushIfNeeded();
+
+    static constexpr int sFlushThreshold = 64 * 1024;
+    Format mFormat;
+    QIODevice *mDevice;
+    QByteArray mBuffer;
+    int mFileCount {0};
+    QStringList mLicenseRefs; //!< license references used in any file, in order of first use
+};
+
+#endif
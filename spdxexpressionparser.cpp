@@ -0,0 +1,334 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "spdxexpressionparser.h"
+#include <QMutexLocker>
+#include <algorithm>
+#include <functional>
+
+namespace
+{
+bool isSeparator(QChar character)
+{
+    return character == QLatin1Char(' ') || character == QLatin1Char('_') || character == QLatin1Char('\t');
+}
+
+// operators are either all upper case or all lower case
+bool isOperator(QStringView token, QLatin1String upperCase)
+{
+    if (token.compare(upperCase, Qt::CaseInsensitive) != 0) {
+        return false;
+    }
+    return token == upperCase || token.toString() == token.toString().toLower();
+}
+}
+
+/**
+ * Recursive descent parser, expects the parser mutex to be locked.
+ */
+class SpdxExpressionParser::Builder
+{
+public:
+    Builder(const SpdxExpressionParser &parser, QStringView text)
+        : mParser(parser)
+    {
+        int position = 0;
+        while (position < text.size()) {
+            if (isSeparator(text.at(position))) {
+                ++position;
+            } else if (text.at(position) == QLatin1Char('(') || text.at(position) == QLatin1Char(')')) {
+                mTokens.append(text.mid(position, 1));
+                ++position;
+            } else {
+                const int start = position;
+                while (position < text.size() && !isSeparator(text.at(position)) && text.at(position) != QLatin1Char('(') && text.at(position) != QLatin1Char(')')) {
+                    ++position;
+                }
+                mTokens.append(text.mid(start, position - start));
+            }
+        }
+    }
+
+    bool build()
+    {
+        if (parseOr() < 0 || mPosition != mTokens.size()) {
+            return false;
+        }
+        return true;
+    }
+
+    Expression mExpression;
+
+private:
+    bool atOperator(QLatin1String name) const
+    {
+        return mPosition < mTokens.size() && isOperator(mTokens.at(mPosition), name);
+    }
+
+    bool atIdentifier() const
+    {
+        if (mPosition >= mTokens.size()) {
+            return false;
+        }
+        const QStringView token = mTokens.at(mPosition);
+        return token != u"(" && token != u")" && !isOperator(token, QLatin1String("AND")) && !isOperator(token, QLatin1String("OR"))
+            && !isOperator(token, QLatin1String("WITH"));
+    }
+
+    int compare(int lhs, int rhs) const
+    {
+        const Node &left = mExpression.nodes.at(lhs);
+        const Node &right = mExpression.nodes.at(rhs);
+        if (left.type != right.type) {
+            return left.type < right.type ? -1 : 1;
+        }
+        if (left.type == NodeType::LICENSE) {
+            return mParser.mIdentifiers.at(left.identifier).compare(mParser.mIdentifiers.at(right.identifier));
+        }
+        const int count = std::min(left.childCount, right.childCount);
+        for (int i = 0; i < count; ++i) {
+            const int result = compare(mExpression.children.at(left.firstChild + i), mExpression.children.at(right.firstChild + i));
+            if (result != 0) {
+                return result;
+            }
+        }
+        if (left.childCount != right.childCount) {
+            return left.childCount < right.childCount ? -1 : 1;
+        }
+        if (left.type == NodeType::WITH) {
+            return mParser.mIdentifiers.at(left.identifier).compare(mParser.mIdentifiers.at(right.identifier));
+        }
+        return 0;
+    }
+
+    int addNode(NodeType type, int identifier, const QVector<int> &operands)
+    {
+        Node node {type, identifier, static_cast<int>(mExpression.children.size()), static_cast<int>(operands.size())};
+        mExpression.children.append(operands);
+        mExpression.nodes.append(node);
+        return mExpression.nodes.size() - 1;
+    }
+
+    int addOperatorNode(NodeType type, const QVector<int> &operands)
+    {
+        if (operands.size() == 1) {
+            return operands.first();
+        }
+        QVector<int> flattened;
+        for (const int operand : operands) {
+            const Node &node = mExpression.nodes.at(operand);
+            if (node.type == type) {
+                for (int i = 0; i < node.childCount; ++i) {
+                    flattened.append(mExpression.children.at(node.firstChild + i));
+                }
+            } else {
+                flattened.append(operand);
+            }
+        }
+        std::sort(flattened.begin(), flattened.end(), [this](int lhs, int rhs) {
+            return compare(lhs, rhs) < 0;
+        });
+        flattened.erase(std::unique(flattened.begin(),
+                                    flattened.end(),
+                                    [this](int lhs, int rhs) {
+                                        return compare(lhs, rhs) == 0;
+                                    }),
+                        flattened.end());
+        if (flattened.size() == 1) {
+            return flattened.first();
+        }
+        return addNode(type, -1, flattened);
+    }
+
+    int parseOr()
+    {
+        QVector<int> operands {parseAnd()};
+        while (operands.constLast() >= 0 && atOperator(QLatin1String("OR"))) {
+            ++mPosition;
+            operands.append(parseAnd());
+        }
+        return operands.constLast() < 0 ? -1 : addOperatorNode(NodeType::OR, operands);
+    }
+
+    int parseAnd()
+    {
+        QVector<int> operands {parseWith()};
+        while (operands.constLast() >= 0 && atOperator(QLatin1String("AND"))) {
+            ++mPosition;
+            operands.append(parseWith());
+        }
+        return operands.constLast() < 0 ? -1 : addOperatorNode(NodeType::AND, operands);
+    }
+
+    int parseWith()
+    {
+        const int license = parsePrimary();
+        if (license < 0 || !atOperator(QLatin1String("WITH"))) {
+            return license;
+        }
+        ++mPosition;
+        if (!atIdentifier() || mExpression.nodes.at(license).type != NodeType::LICENSE) {
+            return -1;
+        }
+        return addNode(NodeType::WITH, mParser.intern(mTokens.at(mPosition++)), {license});
+    }
+
+    int parsePrimary()
+    {
+        if (mPosition < mTokens.size() && mTokens.at(mPosition) == u"(") {
+            ++mPosition;
+            const int node = parseOr();
+            if (node < 0 || mPosition >= mTokens.size() || mTokens.at(mPosition) != u")") {
+                return -1;
+            }
+            ++mPosition;
+            return node;
+        }
+        if (!atIdentifier()) {
+            return -1;
+        }
+        return addNode(NodeType::LICENSE, mParser.intern(mTokens.at(mPosition++)), {});
+    }
+
+    const SpdxExpressionParser &mParser;
+    QVector<QStringView> mTokens;
+    int mPosition {0};
+};
+
+int SpdxExpressionParser::intern(QStringView identifier) const
+{
+    const QString key = identifier.toString();
+    auto iter = mIdentifierIds.constFind(key);
+    if (iter == mIdentifierIds.constEnd()) {
+        iter = mIdentifierIds.insert(key, mIdentifiers.size());
+        mIdentifiers.append(key);
+    }
+    return iter.value();
+}
+
+std::shared_ptr<const SpdxExpressionParser::Expression> SpdxExpressionParser::parse(const QString &expression) const
+{
+    QMutexLocker locker(&mMutex);
+    auto iter = mCache.constFind(expression);
+    if (iter != mCache.constEnd()) {
+        return iter.value();
+    }
+    Builder builder(*this, expression);
+    std::shared_ptr<const Expression> result;
+    if (builder.build()) {
+        result = std::make_shared<const Expression>(std::move(builder.mExpression));
+    }
+    mCache.insert(expression, result);
+    return result;
+}
+
+QString SpdxExpressionParser::identifier(int id) const
+{
+    QMutexLocker locker(&mMutex);
+    return mIdentifiers.value(id);
+}
+
+QStringList SpdxExpressionParser::identifiers(const Expression &expression) const
+{
+    QMutexLocker locker(&mMutex);
+    QStringList result;
+    for (const Node &node : expression.nodes) {
+        if (node.identifier >= 0 && !result.contains(mIdentifiers.at(node.identifier))) {
+            result.append(mIdentifiers.at(node.identifier));
+        }
+    }
+    return result;
+}
+
+QString SpdxExpressionParser::toString(const Expression &expression, QChar separator) const
+{
+    QMutexLocker locker(&mMutex);
+    QString result;
+    std::function<void(int)> append = [&](int index) {
+        const Node &node = expression.nodes.at(index);
+        switch (node.type) {
+        case NodeType::LICENSE:
+            result.append(mIdentifiers.at(node.identifier));
+            break;
+        case NodeType::WITH:
+            append(expression.children.at(node.firstChild));
+            result.append(separator);
+            result.append(QLatin1String("WITH"));
+            result.append(separator);
+            result.append(mIdentifiers.at(node.identifier));
+            break;
+        case NodeType::AND:
+        case NodeType::OR:
+            for (int i = 0; i < node.childCount; ++i) {
+                if (i > 0) {
+                    result.append(separator);
+                    result.append(QLatin1String(node.type == NodeType::AND ? "AND" : "OR"));
+                    result.append(separator);
+                }
+                const int child = expression.children.at(node.firstChild + i);
+                // AND binds stronger than OR, thus only OR operands of AND need parentheses
+                const bool parentheses = node.type == NodeType::AND && expression.nodes.at(child).type == NodeType::OR;
+                if (parentheses) {
+                    result.append(QLatin1Char('('));
+                }
+                append(child);
+                if (parentheses) {
+                    result.append(QLatin1Char(')'));
+                }
+            }
+            break;
+        }
+    };
+    if (!expression.nodes.isEmpty()) {
+        append(expression.root());
+    }
+    return result;
+}
+
+bool SpdxExpressionParser::isEqual(const Expression &lhs, int lhsNode, const Expression &rhs, int rhsNode)
+{
+    const Node &left = lhs.nodes.at(lhsNode);
+    const Node &right = rhs.nodes.at(rhsNode);
+    if (left.type != right.type || left.identifier != right.identifier || left.childCount != right.childCount) {
+        return false;
+    }
+    // operands are sorted canonically
+    for (int i = 0; i < left.childCount; ++i) {
+        if (!isEqual(lhs, lhs.children.at(left.firstChild + i), rhs, rhs.children.at(right.firstChild + i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SpdxExpressionParser::containsTerm(const Expression &outer, const Expression &inner)
+{
+    if (inner.nodes.isEmpty()) {
+        return false;
+    }
+    const Node &innerRoot = inner.nodes.at(inner.root());
+    for (int index = 0; index < outer.nodes.size(); ++index) {
+        if (isEqual(outer, index, inner, inner.root())) {
+            return true;
+        }
+        const Node &node = outer.nodes.at(index);
+        if ((node.type != NodeType::AND && node.type != NodeType::OR) || node.type != innerRoot.type || node.childCount < innerRoot.childCount) {
+            continue;
+        }
+        const bool isSubset = std::all_of(inner.children.constBegin() + innerRoot.firstChild, inner.children.constBegin() + innerRoot.firstChild + innerRoot.childCount, [&](int innerChild) {
+            for (int i = 0; i < node.childCount; ++i) {
+                if (isEqual(outer, outer.children.at(node.firstChild + i), inner, innerChild)) {
+                    return true;
+                }
+            }
+            return false;
+        });
+        if (isSubset) {
+            return true;
+        }
+    }
+    return false;
+}
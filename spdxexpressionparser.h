@@ -0,0 +1,96 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef SPDXEXPRESSIONPARSER_H
+#define SPDXEXPRESSIONPARSER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+
+/**
+ * @brief Parser for SPDX license expressions into canonical syntax trees
+ *
+ * Both the syntax of SPDX-License-Identifier statements ("A OR B") and the one of registry
+ * expressions ("A_OR_B") are accepted. Operator precedence is WITH before AND before OR, and
+ * parentheses are supported. Identifiers are interned, such that trees can be compared without
+ * any string comparisons. Trees are canonical: nested operands of the same operator are
+ * flattened, and operands are sorted and deduplicated, thus "B OR (A OR B)" and "A OR B" have
+ * identical trees.
+ *
+ * Parsed expressions are cached. All methods are thread-safe.
+ */
+class SpdxExpressionParser
+{
+public:
+    enum class NodeType : quint8 { LICENSE, WITH, AND, OR };
+    struct Node {
+        NodeType type;
+        int identifier {-1}; //!< interned license identifier for LICENSE, exception identifier for WITH
+        int firstChild {0}; //!< position of first operand in Expression::children
+        int childCount {0};
+    };
+    /**
+     * Nodes are stored in post order, the root is the last node.
+     */
+    struct Expression {
+        QVector<Node> nodes;
+        QVector<int> children;
+        int root() const
+        {
+            return nodes.size() - 1;
+        }
+    };
+
+    /**
+     * @return syntax tree of @p expression or nullptr if @p expression is no valid SPDX expression
+     */
+    std::shared_ptr<const Expression> parse(const QString &expression) const;
+
+    /**
+     * @return identifier string of interned identifier @p id
+     */
+    QString identifier(int id) const;
+
+    /**
+     * @brief all license and exception identifiers of @p expression, each listed once
+     */
+    QStringList identifiers(const Expression &expression) const;
+
+    /**
+     * @brief canonical string representation of @p expression
+     * @param separator word separator, "_" results in registry expression syntax
+     */
+    QString toString(const Expression &expression, QChar separator = QLatin1Char(' ')) const;
+
+    /**
+     * @return true if the subtrees at @p lhsNode and @p rhsNode are identical
+     */
+    static bool isEqual(const Expression &lhs, int lhsNode, const Expression &rhs, int rhsNode);
+
+    /**
+     * @brief check if @p inner is a term of @p outer
+     *
+     * This is the case if @p inner equals @p outer or any of its subtrees, if it is the license of a
+     * WITH statement, or if it combines a subset of the operands of an AND or OR statement with the
+     * same operator. E.g. "A", "A WITH E" and "A OR C" are terms of "(A WITH E) OR B OR C".
+     */
+    static bool containsTerm(const Expression &outer, const Expression &inner);
+
+private:
+    class Builder;
+    int intern(QStringView identifier) const;
+
+    mutable QMutex mMutex;
+    mutable QHash<QString, int> mIdentifierIds;
+    mutable QVector<QString> mIdentifiers;
+    mutable QHash<QString, std::shared_ptr<const Expression>> mCache;
+};
+
+#endif
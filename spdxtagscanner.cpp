@@ -0,0 +1,93 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "spdxtagscanner.h"
+#include <QString>
+#include <algorithm>
+#include <array>
+
+namespace
+{
+const QLatin1String sTagPrefix("SPDX-");
+const QLatin1String sLicenseIdentifierTag("License-Identifier:");
+const QLatin1String sFileCopyrightTextTag("FileCopyrightText:");
+// closing comment markers of the languages of DirectoryParser::s_supportedExtensions
+const std::array<QLatin1String, 2> sCommentTerminators {QLatin1String("*/"), QLatin1String("-->")};
+
+bool isHorizontalSpace(QChar character)
+{
+    return character == QLatin1Char(' ') || character == QLatin1Char('\t');
+}
+}
+
+std::optional<SpdxTagScanner::Statement> SpdxTagScanner::findNext(QStringView text, int from, int windowSize)
+{
+    const int windowEnd = std::min<int>(text.size(), windowSize);
+    while (from < windowEnd) {
+        const int tagStart = static_cast<int>(text.indexOf(sTagPrefix, from));
+        if (tagStart < 0 || tagStart >= windowEnd) {
+            return {};
+        }
+        from = tagStart + sTagPrefix.size();
+
+        Statement statement;
+        statement.start = tagStart;
+        const QStringView afterPrefix = text.mid(from);
+        int position = 0;
+        if (afterPrefix.startsWith(sLicenseIdentifierTag)) {
+            statement.tag = Tag::LICENSE_IDENTIFIER;
+            position = from + sLicenseIdentifierTag.size();
+        } else if (afterPrefix.startsWith(sFileCopyrightTextTag)) {
+            statement.tag = Tag::FILE_COPYRIGHT_TEXT;
+            position = from + sFileCopyrightTextTag.size();
+        } else {
+            continue;
+        }
+
+        int lineEnd = static_cast<int>(text.indexOf(QLatin1Char('\n'), position));
+        if (lineEnd < 0) {
+            lineEnd = static_cast<int>(text.size());
+        }
+        statement.end = lineEnd;
+
+        int valueEnd = lineEnd;
+        bool trimmed = true;
+        while (trimmed) {
+            trimmed = false;
+            while (valueEnd > position && (isHorizontalSpace(text.at(valueEnd - 1)) || text.at(valueEnd - 1) == QLatin1Char('\r'))) {
+                --valueEnd;
+                trimmed = true;
+            }
+            for (const auto &terminator : sCommentTerminators) {
+                if (text.mid(position, valueEnd - position).endsWith(terminator)) {
+                    valueEnd -= terminator.size();
+                    trimmed = true;
+                }
+            }
+        }
+        while (position < valueEnd && isHorizontalSpace(text.at(position))) {
+            ++position;
+        }
+        if (position == valueEnd) {
+            continue;
+        }
+        statement.valueStart = position;
+        statement.valueLength = valueEnd - position;
+        return statement;
+    }
+    return {};
+}
+
+QVector<SpdxTagScanner::Statement> SpdxTagScanner::findAll(QStringView text, int windowSize)
+{
+    QVector<Statement> statements;
+    int position = 0;
+    while (const auto statement = findNext(text, position, windowSize)) {
+        statements.append(*statement);
+        position = statement->end;
+    }
+    return statements;
+}
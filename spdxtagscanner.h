@@ -0,0 +1,47 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef SPDXTAGSCANNER_H
+#define SPDXTAGSCANNER_H
+
+#include <QStringView>
+#include <QVector>
+#include <optional>
+
+/**
+ * @brief Scanner for "SPDX-License-Identifier:" and "SPDX-FileCopyrightText:" tags
+ *
+ * Tags are found by a plain substring search for "SPDX-" and are only accepted within a window at
+ * the beginning of the text, where file headers are located. The value of a tag extends to the end
+ * of its line, without surrounding whitespace and without trailing comment terminators like "*\/".
+ */
+class SpdxTagScanner
+{
+public:
+    enum class Tag { LICENSE_IDENTIFIER, FILE_COPYRIGHT_TEXT };
+    struct Statement {
+        Tag tag;
+        int start {-1}; //!< position of the tag
+        int end {-1}; //!< end of the line of the tag
+        int valueStart {-1};
+        int valueLength {0};
+    };
+
+    static constexpr int sDefaultWindowSize = 32 * 1024;
+
+    /**
+     * @brief find first tag with non-empty value that starts at or after @p from
+     * @param windowSize tags must start before this position
+     */
+    static std::optional<Statement> findNext(QStringView text, int from = 0, int windowSize = sDefaultWindowSize);
+
+    /**
+     * @brief all tags with non-empty values in one pass
+     */
+    static QVector<Statement> findAll(QStringView text, int windowSize = sDefaultWindowSize);
+};
+
+#endif
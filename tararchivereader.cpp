@@ -0,0 +1,319 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "tararchivereader.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <zlib.h>
+
+namespace
+{
+constexpr int sBlockSize = 512;
+constexpr int sChunkSize = 64 * 1024;
+// GNU long names and pax headers are read into memory, larger ones indicate a corrupt archive
+constexpr qint64 sMaxMetadataSize = 1024 * 1024;
+
+QString parseString(const char *field, int maxLength)
+{
+    return QString::fromUtf8(field, static_cast<int>(qstrnlen(field, maxLength)));
+}
+
+// octal number, or big-endian base-256 number if the high bit of the first byte is set
+qint64 parseNumber(const char *field, int length)
+{
+    qint64 value = 0;
+    if (static_cast<uchar>(field[0]) & 0x80) {
+        value = static_cast<uchar>(field[0]) & 0x7f;
+        for (int i = 1; i < length; ++i) {
+            if (value > (std::numeric_limits<qint64>::max() >> 8)) {
+                return -1;
+            }
+            value = (value << 8) | static_cast<uchar>(field[i]);
+        }
+        return value;
+    }
+    int i = 0;
+    while (i < length && (field[i] == ' ' || field[i] == '\0')) {
+        ++i;
+    }
+    for (; i < length && field[i] >= '0' && field[i] <= '7'; ++i) {
+        value = value * 8 + (field[i] - '0');
+    }
+    return value;
+}
+
+bool hasValidChecksum(const char *header)
+{
+    // the checksum field itself is summed up as if it contained spaces
+    qint64 sum = 8 * ' ';
+    for (int i = 0; i < sBlockSize; ++i) {
+        if (i < 148 || i >= 156) {
+            sum += static_cast<uchar>(header[i]);
+        }
+    }
+    return sum == parseNumber(header + 148, 8);
+}
+
+// pax records have the form "<length> <key>=<value>\n"
+QString paxPath(const QByteArray &records)
+{
+    QString path;
+    int position = 0;
+    while (position < records.size()) {
+        const int space = records.indexOf(' ', position);
+        if (space < 0) {
+            break;
+        }
+        bool ok = false;
+        const int length = records.mid(position, space - position).toInt(&ok);
+        if (!ok || length <= space - position || position + length > records.size()) {
+            break;
+        }
+        const QByteArray record = records.mid(space + 1, position + length - space - 2);
+        if (record.startsWith("path=")) {
+            path = QString::fromUtf8(record.mid(5));
+        }
+        position += length;
+    }
+    return path;
+}
+}
+
+TarArchiveReader::TarArchiveReader(QIODevice *device)
+    : mDevice(device)
+{
+}
+
+TarArchiveReader::~TarArchiveReader()
+{
+    if (mStream) {
+        inflateEnd(mStream.get());
+    }
+}
+
+bool TarArchiveReader::isArchiveFileName(const QString &fileName)
+{
+    return fileName.endsWith(QLatin1String(".tar")) || fileName.endsWith(QLatin1String(".tar.gz")) || fileName.endsWith(QLatin1String(".tgz"));
+}
+
+bool TarArchiveReader::hasError() const
+{
+    return !mErrorString.isEmpty();
+}
+
+QString TarArchiveReader::errorString() const
+{
+    return mErrorString;
+}
+
+bool TarArchiveReader::setError(const QString &message)
+{
+    if (mErrorString.isEmpty()) {
+        mErrorString = message;
+    }
+    return false;
+}
+
+bool TarArchiveReader::initialize()
+{
+    mInitialized = true;
+    const QByteArray magic = mDevice->peek(2);
+    if (magic.size() == 2 && static_cast<uchar>(magic.at(0)) == 0x1f && static_cast<uchar>(magic.at(1)) == 0x8b) {
+        // value-initialized, i.e. with zlib's default allocators
+        mStream = std::make_unique<z_stream_s>();
+        // window bits of 16 + MAX_WBITS select the gzip format
+        if (inflateInit2(mStream.get(), 16 + MAX_WBITS) != Z_OK) {
+            mStream.reset();
+            return setError(QStringLiteral("Could not initialize gzip decompression"));
+        }
+        mInput.resize(sChunkSize);
+    }
+    return true;
+}
+
+qint64 TarArchiveReader::read(char *data, qint64 maxSize)
+{
+    if (!mStream) {
+        return mDevice->read(data, maxSize);
+    }
+    mStream->next_out = reinterpret_cast<Bytef *>(data);
+    mStream->avail_out = static_cast<uInt>(std::min<qint64>(maxSize, std::numeric_limits<uInt>::max()));
+    while (mStream->avail_out > 0) {
+        if (mStream->avail_in == 0) {
+            const qint64 bytesRead = mDevice->read(mInput.data(), mInput.size());
+            if (bytesRead < 0) {
+                setError(mDevice->errorString());
+                return -1;
+            }
+            if (bytesRead == 0) {
+                if (!mStreamEnded) {
+                    setError(QStringLiteral("Truncated gzip stream"));
+                    return -1;
+                }
+                break;
+            }
+            mStream->next_in = reinterpret_cast<Bytef *>(mInput.data());
+            mStream->avail_in = static_cast<uInt>(bytesRead);
+        }
+        // concatenated gzip members form one stream
+        if (mStreamEnded) {
+            inflateReset(mStream.get());
+            mStreamEnded = false;
+        }
+        const int result = inflate(mStream.get(), Z_NO_FLUSH);
+        if (result == Z_STREAM_END) {
+            mStreamEnded = true;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            setError(QStringLiteral("Corrupt gzip stream: %1").arg(QString::fromUtf8(mStream->msg ? mStream->msg : "unknown error")));
+            return -1;
+        }
+    }
+    return reinterpret_cast<char *>(mStream->next_out) - data;
+}
+
+bool TarArchiveReader::readFully(char *data, qint64 size)
+{
+    while (size > 0) {
+        const qint64 bytesRead = read(data, size);
+        if (bytesRead < 0) {
+            return false;
+        }
+        if (bytesRead == 0) {
+            return setError(QStringLiteral("Unexpected end of archive"));
+        }
+        data += bytesRead;
+        size -= bytesRead;
+    }
+    return true;
+}
+
+bool TarArchiveReader::skip(qint64 size)
+{
+    if (size == 0) {
+        return true;
+    }
+    if (!mStream && !mDevice->isSequential()) {
+        if (mDevice->pos() + size > mDevice->size()) {
+            return setError(QStringLiteral("Unexpected end of archive"));
+        }
+        return mDevice->seek(mDevice->pos() + size) || setError(mDevice->errorString());
+    }
+    if (mScratch.size() < sChunkSize) {
+        mScratch.resize(sChunkSize);
+    }
+    while (size > 0) {
+        const qint64 chunk = std::min<qint64>(size, mScratch.size());
+        if (!readFully(mScratch.data(), chunk)) {
+            return false;
+        }
+        size -= chunk;
+    }
+    return true;
+}
+
+bool TarArchiveReader::next(Entry *entry)
+{
+    if (hasError() || (!mInitialized && !initialize())) {
+        return false;
+    }
+    if (!skip(mRemaining + mPadding)) {
+        return false;
+    }
+    mRemaining = 0;
+    mPadding = 0;
+
+    QString longName;
+    QString extendedPath;
+    char header[sBlockSize];
+    while (true) {
+        const qint64 bytesRead = read(header, sBlockSize);
+        if (bytesRead == 0) {
+            // archives without end-of-archive blocks are tolerated
+            return false;
+        }
+        if (bytesRead != sBlockSize && (bytesRead < 0 || !readFully(header + bytesRead, sBlockSize - bytesRead))) {
+            return false;
+        }
+        if (std::all_of(header, header + sBlockSize, [](char byte) {
+                return byte == '\0';
+            })) {
+            return false;
+        }
+        if (!hasValidChecksum(header)) {
+            return setError(QStringLiteral("Invalid tar header"));
+        }
+        const qint64 size = parseNumber(header + 124, 12);
+        if (size < 0) {
+            return setError(QStringLiteral("Invalid entry size"));
+        }
+        const qint64 padding = (sBlockSize - size % sBlockSize) % sBlockSize;
+        const char type = header[156];
+
+        if (type == 'L' || type == 'x') {
+            if (size > sMaxMetadataSize) {
+                return setError(QStringLiteral("Invalid extended header"));
+            }
+            QByteArray data(static_cast<int>(size), Qt::Uninitialized);
+            if (!readFully(data.data(), size) || !skip(padding)) {
+                return false;
+            }
+            if (type == 'L') {
+                longName = parseString(data.constData(), data.size());
+            } else {
+                extendedPath = paxPath(data);
+            }
+            continue;
+        }
+        // directories, links, devices and global pax headers
+        if (type != '0' && type != '\0' && type != '7') {
+            if (!skip(size + padding)) {
+                return false;
+            }
+            longName.clear();
+            extendedPath.clear();
+            continue;
+        }
+
+        QString path;
+        if (!extendedPath.isEmpty()) {
+            path = extendedPath;
+        } else if (!longName.isEmpty()) {
+            path = longName;
+        } else {
+            path = parseString(header, 100);
+            // only POSIX headers have a prefix field, old GNU headers ("ustar  \0") store times there
+            const QString prefix = std::memcmp(header + 257, "ustar\0", 6) == 0 ? parseString(header + 345, 155) : QString();
+            if (!prefix.isEmpty()) {
+                path = prefix + QLatin1Char('/') + path;
+            }
+        }
+        while (path.startsWith(QLatin1String("./"))) {
+            path.remove(0, 2);
+        }
+        while (path.startsWith(QLatin1Char('/'))) {
+            path.remove(0, 1);
+        }
+        entry->path = path;
+        entry->size = size;
+        mRemaining = size;
+        mPadding = padding;
+        return true;
+    }
+}
+
+bool TarArchiveReader::readContent(QByteArray *content)
+{
+    if (mRemaining > std::numeric_limits<int>::max()) {
+        return setError(QStringLiteral("Entry exceeds maximal size"));
+    }
+    content->resize(static_cast<int>(mRemaining));
+    if (!readFully(content->data(), mRemaining)) {
+        return false;
+    }
+    mRemaining = 0;
+    return true;
+}
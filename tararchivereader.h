@@ -0,0 +1,77 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef TARARCHIVEREADER_H
+#define TARARCHIVEREADER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QString>
+#include <memory>
+
+struct z_stream_s;
+
+/**
+ * @brief Sequential reader for tar archives, uncompressed or gzip compressed
+ *
+ * The archive is read in a single pass, without any temporary files. Entries are visited with next(),
+ * and only the content of entries for which readContent() is called is kept in memory; the content
+ * of all other entries is skipped, on seekable uncompressed archives without reading it.
+ *
+ * Supported are ustar, GNU long names and pax path records. Only regular files are reported.
+ */
+class TarArchiveReader
+{
+public:
+    struct Entry {
+        QString path; //!< path inside the archive, without leading "./"
+        qint64 size {0};
+    };
+
+    /**
+     * @param device opened device, gzip compression is detected from its first bytes
+     */
+    explicit TarArchiveReader(QIODevice *device);
+    ~TarArchiveReader();
+
+    /**
+     * @return true for names of archives that can be read, i.e. ending with .tar, .tar.gz or .tgz
+     */
+    static bool isArchiveFileName(const QString &fileName);
+
+    /**
+     * @brief advance to the next regular file, the unread content of the current entry is skipped
+     * @return false at the end of the archive or on errors, see hasError()
+     */
+    bool next(Entry *entry);
+
+    /**
+     * @brief read the complete content of the current entry into @p content
+     */
+    bool readContent(QByteArray *content);
+
+    bool hasError() const;
+    QString errorString() const;
+
+private:
+    bool initialize();
+    qint64 read(char *data, qint64 maxSize);
+    bool readFully(char *data, qint64 size);
+    bool skip(qint64 size);
+    bool setError(const QString &message);
+
+    QIODevice *mDevice;
+    std::unique_ptr<z_stream_s> mStream; //!< only set for compressed archives
+    QByteArray mInput;
+    QByteArray mScratch;
+    bool mInitialized {false};
+    bool mStreamEnded {false};
+    qint64 mRemaining {0}; //!< unread content bytes of the current entry
+    qint64 mPadding {0}; //!< padding after the content of the current entry
+    QString mErrorString;
+};
+
+#endif
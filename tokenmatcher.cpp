@@ -0,0 +1,132 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#include "tokenmatcher.h"
+#include "licensetokenizer.h"
+#include <QtGlobal>
+#include <algorithm>
+
+int TokenMatcher::addTemplate(const QString &expression, const QString &text)
+{
+    std::vector<LicenseTokenizer::Token> tokens;
+    LicenseTokenizer::tokenize(text, tokens);
+
+    Template entry;
+    entry.expression = expression;
+    entry.tokens.reserve(tokens.size());
+    for (const auto &token : tokens) {
+        const quint64 hash = LicenseTokenizer::tokenHash(QStringView(text).mid(token.start, token.end - token.start));
+        auto iter = mVocabulary.constFind(hash);
+        if (iter == mVocabulary.constEnd()) {
+            iter = mVocabulary.insert(hash, mVocabulary.size());
+        }
+        entry.tokens.push_back(iter.value());
+    }
+    mTemplates.push_back(std::move(entry));
+    mFinalized = false;
+    return static_cast<int>(mTemplates.size()) - 1;
+}
+
+QString TokenMatcher::expression(int templateIndex) const
+{
+    return mTemplates.at(templateIndex).expression;
+}
+
+int TokenMatcher::templateCount() const
+{
+    return static_cast<int>(mTemplates.size());
+}
+
+int TokenMatcher::tokenId(quint64 tokenHash) const
+{
+    return mVocabulary.value(tokenHash, sUnknownToken);
+}
+
+void TokenMatcher::finalize()
+{
+    // anchor length depends on the shortest template, thus anchors are built once for all templates
+    mFinalized = true;
+    mAnchors.clear();
+    mAnchorLength = sMaxAnchorLength;
+    for (const auto &entry : mTemplates) {
+        if (!entry.tokens.empty()) {
+            mAnchorLength = std::min(mAnchorLength, static_cast<int>(entry.tokens.size()));
+        }
+    }
+    mAnchorBasePower = 1;
+    for (int i = 0; i < mAnchorLength; ++i) {
+        mAnchorBasePower *= sHashBase;
+    }
+    for (int index = 0; index < static_cast<int>(mTemplates.size()); ++index) {
+        const auto &tokens = mTemplates[index].tokens;
+        if (tokens.empty()) {
+            continue;
+        }
+        quint64 hash = 0;
+        for (int i = 0; i < mAnchorLength; ++i) {
+            hash = hash * sHashBase + static_cast<quint64>(tokens[i] + 1);
+        }
+        mAnchors[hash].push_back(index);
+    }
+}
+
+QVector<TokenMatcher::Match> TokenMatcher::findMatches(const QString &text) const
+{
+    // scratch buffers are reused between calls of the same thread
+    thread_local std::vector<LicenseTokenizer::Token> tokens;
+    thread_local std::vector<int> ids;
+    thread_local std::vector<bool> matched;
+
+    Q_ASSERT(mFinalized);
+    QVector<Match> matches;
+    if (mTemplates.empty()) {
+        return matches;
+    }
+
+    LicenseTokenizer::tokenize(text, tokens);
+    ids.resize(tokens.size());
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        ids[i] = tokenId(LicenseTokenizer::tokenHash(QStringView(text).mid(tokens[i].start, tokens[i].end - tokens[i].start)));
+    }
+    matched.assign(mTemplates.size(), false);
+
+    // rolling hash over the last mAnchorLength tokens, restarted at every unknown token
+    const int textLength = static_cast<int>(ids.size());
+    quint64 hash = 0;
+    int knownTokens = 0;
+    for (int i = 0; i < textLength; ++i) {
+        if (ids[i] == sUnknownToken) {
+            hash = 0;
+            knownTokens = 0;
+            continue;
+        }
+        hash = hash * sHashBase + static_cast<quint64>(ids[i] + 1);
+        ++knownTokens;
+        if (knownTokens > mAnchorLength) {
+            hash -= static_cast<quint64>(ids[i - mAnchorLength] + 1) * mAnchorBasePower;
+        }
+        if (knownTokens < mAnchorLength) {
+            continue;
+        }
+        auto candidates = mAnchors.constFind(hash);
+        if (candidates == mAnchors.constEnd()) {
+            continue;
+        }
+        const int start = i - mAnchorLength + 1;
+        for (int index : candidates.value()) {
+            const auto &templateTokens = mTemplates[index].tokens;
+            const int length = static_cast<int>(templateTokens.size());
+            if (matched[index] || start + length > textLength) {
+                continue;
+            }
+            if (std::equal(templateTokens.cbegin(), templateTokens.cend(), ids.cbegin() + start)) {
+                matched[index] = true;
+                matches.append({index, tokens[start].start, tokens[start + length - 1].end - 1});
+            }
+        }
+    }
+    return matches;
+}
@@ -0,0 +1,75 @@
+/*
+ *  SPDX-FileCopyrightText: 2026  Andreas Cord-Landwehr <cordlandwehr@kde.org>
+ *
+ *  SPDX-License-Identifier: GPL-2.0-only OR GPL-3.0-only OR LicenseRef-KDE-Accepted-GPL
+ */
+
+#ifndef TOKENMATCHER_H
+#define TOKENMATCHER_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <vector>
+
+/**
+ * @brief Exact multi-template matcher over normalized token sequences
+ *
+ * Templates are tokenized with LicenseTokenizer and each token is mapped to an integer id. Texts are
+ * mapped to the same ids, where tokens that do not occur in any template cannot be part of a match.
+ * Matching is a Rabin-Karp search: a rolling hash over the first tokens of all templates selects
+ * candidate templates, which are then verified token by token. The runtime thus is linear in the
+ * text length, independent of line breaks, comment markers, punctuation and letter case.
+ *
+ * All templates must be added before finalize() builds the anchors, and texts can only be matched
+ * afterwards.
+ */
+class TokenMatcher
+{
+public:
+    struct Match {
+        int templateIndex;
+        int start; //!< position of first matched character in text
+        int end; //!< position of last matched character in text
+    };
+
+    /**
+     * @brief add template for the given expression
+     * @return index of the template
+     */
+    int addTemplate(const QString &expression, const QString &text);
+
+    /**
+     * @brief build the anchors of all added templates, must be called before findMatches()
+     */
+    void finalize();
+
+    QString expression(int templateIndex) const;
+
+    int templateCount() const;
+
+    /**
+     * @brief compute all template matches in @p text, at most one per template
+     */
+    QVector<Match> findMatches(const QString &text) const;
+
+private:
+    static constexpr int sUnknownToken = -1;
+    static constexpr int sMaxAnchorLength = 8;
+    static constexpr quint64 sHashBase = 1000003;
+
+    int tokenId(quint64 tokenHash) const;
+
+    struct Template {
+        QString expression;
+        std::vector<int> tokens;
+    };
+    QHash<quint64, int> mVocabulary;
+    std::vector<Template> mTemplates;
+    bool mFinalized {true}; //!< false while templates were added after the last finalize()
+    int mAnchorLength {0};
+    quint64 mAnchorBasePower {1}; //!< sHashBase^mAnchorLength
+    QHash<quint64, std::vector<int>> mAnchors; //!< rolling hash of first template tokens to templates
+};
+
+#endif